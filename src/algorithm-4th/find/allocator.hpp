@@ -0,0 +1,111 @@
+#ifndef _TREE_ALLOCATOR_H_
+#define _TREE_ALLOCATOR_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ 树节点的分配策略，作为树的模板参数：
+   - create(args...)构造一个节点，destroy(p)析构并回收一个节点；
+   - canReleaseAll()为true时，树销毁时不用逐个destroy节点，直接releaseAll()整块释放；
+   - releaseAll()在所有节点都析构之后调用，释放分配器自己持有的内存。
+ */
+
+//每个节点单独new/delete
+template<typename T>
+class HeapAllocator {
+public:
+    template<typename... Args>
+    T *create(Args &&... args) {
+        return new T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T *p) {
+        delete p;
+    }
+
+    bool canReleaseAll() const { return false; }
+
+    void releaseAll() {}
+};
+
+/*
+ 按块(slab)分配：一次申请能放SLAB_BYTES字节节点的一块内存，节点在块里依次往后分配，
+ 插入顺序相近的节点在内存里也挨在一起；
+ destroy的节点挂到空闲链表上(链表指针就放在节点原来的内存里)，下一次create优先复用；
+ 节点不需要析构(键和值都是基本类型)时，销毁整棵树不用遍历节点，所有块一次释放。
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+    ArenaAllocator() : freeList(nullptr), next(nullptr), end(nullptr) {}
+
+    ~ArenaAllocator() { releaseAll(); }
+
+    ArenaAllocator(const ArenaAllocator &) = delete;
+
+    ArenaAllocator &operator=(const ArenaAllocator &) = delete;
+
+    template<typename... Args>
+    T *create(Args &&... args) {
+        void *p;
+        if (freeList != nullptr) {
+            p = freeList;
+            freeList = freeList->next;
+        } else {
+            if (next == end)
+                newSlab();
+            p = next;
+            next += sizeof(Slot);
+        }
+        return new(p) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T *p) {
+        p->~T();
+        FreeNode *node = reinterpret_cast<FreeNode *>(p);
+        node->next = freeList;
+        freeList = node;
+    }
+
+    bool canReleaseAll() const { return std::is_trivially_destructible<T>::value; }
+
+    void releaseAll() {
+        for (char *slab : slabs)
+            ::operator delete(slab);
+        slabs.clear();
+        freeList = nullptr;
+        next = end = nullptr;
+    }
+
+private:
+    struct FreeNode {
+        FreeNode *next;
+    };
+
+    //一个节点占的位置，大小和对齐都能放下T和空闲链表的指针
+    union Slot {
+        FreeNode free;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type node;
+    };
+
+    static const size_t SLAB_BYTES = 64 * 1024;
+    static const size_t SLAB_SLOTS = SLAB_BYTES / sizeof(Slot) > 0 ? SLAB_BYTES / sizeof(Slot) : 1;
+
+    FreeNode *freeList;
+    char *next;     //当前块里下一个没分配过的位置
+    char *end;
+    std::vector<char *> slabs;
+
+    void newSlab() {
+        char *slab = static_cast<char *>(::operator new(SLAB_SLOTS * sizeof(Slot)));
+        slabs.push_back(slab);
+        next = slab;
+        end = slab + SLAB_SLOTS * sizeof(Slot);
+    }
+};
+
+#endif
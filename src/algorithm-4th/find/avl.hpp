@@ -2,8 +2,14 @@
 #define _AVL_TREE_H_
 
 #include <cstdio>
+#include <vector>
 
-template<typename K, typename V>
+#include "allocator.hpp"
+#include "tree-iterator.hpp"
+#include "tree-stats.hpp"
+
+//Allocator是节点的分配策略，见allocator.hpp
+template<typename K, typename V, template<typename> class Allocator = HeapAllocator>
 class AVLTree {
     struct Node {
         int size;
@@ -12,12 +18,15 @@ class AVLTree {
         V val;
         Node *left;
         Node *right;
+        Node *parent;
 
-        Node(K key, V value) : key(key), val(value), height(1), left(nullptr), right(nullptr) {}
+        Node(K key, V value) : height(1), key(key), val(value), left(nullptr), right(nullptr), parent(nullptr) {}
     };
 
     Node *root;
     int count;
+    Allocator<Node> nodes;
+    TreeWriteCount writes;
 public:
     AVLTree() : root(nullptr), count(0) {}
 
@@ -70,7 +79,27 @@ public:
      * @param val the value
      * @throws IllegalArgumentException if {@code key} is {@code nullptr}
      */
-    void add(const K &key, const V &value) { root = add(root, key, value); }
+    void add(const K &key, const V &value) {
+        Node *parent = nullptr;
+        Node *x = root;
+        while (x != nullptr) {
+            parent = x;
+            if (key < x->key) x = x->left;
+            else if (x->key < key) x = x->right;
+            else {
+                x->val = value;
+                return;
+            }
+        }
+        Node *z = nodes.create(key, value);
+        z->parent = parent;
+        if (parent == nullptr) root = z;
+        else if (key < parent->key) parent->left = z;
+        else parent->right = z;
+        TREE_COUNT_WRITE(links, 2);
+        count++;
+        retrace(parent);
+    }
 
 
     /**
@@ -81,8 +110,9 @@ public:
      * @throws IllegalArgumentException if {@code key} is {@code nullptr}
      */
     void remove(const K &key) {
-        if (getNode(root, key) == nullptr) return;
-        root = remove(root, key);
+        Node *z = getNode(root, key);
+        if (z == nullptr) return;
+        removeNode(z);
     }
 
     /**
@@ -176,7 +206,7 @@ public:
      * @throws NoSuchElementException if the symbol table is empty
      */
     void removeMin() {
-        root = removeMin(root);
+        if (root != nullptr) removeNode(min(root));
     }
 
     /**
@@ -185,82 +215,158 @@ public:
      * @throws NoSuchElementException if the symbol table is empty
      */
     void removeMax() {
-        root = removeMax(root);
+        if (root != nullptr) removeNode(max(root));
+    }
+
+    //定义了TREE_COUNT_WRITES时add/remove写节点的次数，见tree-stats.hpp
+    const TreeWriteCount &writeCount() const { return writes; }
+
+    void resetWriteCount() { writes = TreeWriteCount(); }
+
+    typedef TreeIterator<Node, K, V> iterator;
+
+    iterator begin() const { return iterator::first(root); }
+
+    iterator end() const { return iterator(root); }
+
+    //第一个大于等于key的位置
+    iterator lowerBound(const K &key) const { return iterator::lowerBound(root, key); }
+
+    //第一个大于key的位置
+    iterator upperBound(const K &key) const { return iterator::upperBound(root, key); }
+
+    //按顺序访问[lo, hi]里的每一对键值，visit(key, val)，O(log n + k)
+    template<typename F>
+    void range(const K &lo, const K &hi, F visit) const {
+        const iterator last = end();
+        for (iterator it = lowerBound(lo); it != last && !(hi < *it); ++it)
+            visit(it.key(), it.value());
+    }
+
+    /*
+     用有序的keys[0, len)、vals[0, len)直接建一棵完全平衡的树，O(n)，不用旋转，树里原来的键值都清掉
+     键要严格递增；不是的话退化成逐个add
+     */
+    void bulkLoad(const K *keys, const V *vals, const int len) {
+        destroy();
+        if (!isIncreasing(keys, len)) {
+            for (int i = 0; i < len; i++)
+                add(keys[i], vals[i]);
+            return;
+        }
+        root = build(keys, vals, 0, len - 1);
+        count = len;
+    }
+
+    //有序的keys/vals和树里已有的键值归并之后重建，键相同时用新的值，O(n + size())
+    void bulkMerge(const K *keys, const V *vals, const int len) {
+        if (!isIncreasing(keys, len)) {
+            for (int i = 0; i < len; i++)
+                add(keys[i], vals[i]);
+            return;
+        }
+        std::vector<K> mergedKeys;
+        std::vector<V> mergedVals;
+        mergedKeys.reserve(count + len);
+        mergedVals.reserve(count + len);
+        std::vector<Node *> stack;
+        Node *x = root;
+        int i = 0;
+        while (x != nullptr || !stack.empty()) {
+            for (; x != nullptr; x = x->left)
+                stack.push_back(x);
+            x = stack.back();
+            stack.pop_back();
+            for (; i < len && keys[i] < x->key; i++) {
+                mergedKeys.push_back(keys[i]);
+                mergedVals.push_back(vals[i]);
+            }
+            mergedKeys.push_back(x->key);
+            if (i < len && !(x->key < keys[i]))
+                mergedVals.push_back(vals[i++]);
+            else
+                mergedVals.push_back(x->val);
+            x = x->right;
+        }
+        for (; i < len; i++) {
+            mergedKeys.push_back(keys[i]);
+            mergedVals.push_back(vals[i]);
+        }
+        bulkLoad(mergedKeys.data(), mergedVals.data(), (int) mergedKeys.size());
     }
 
     void destroy() {
-        destroy(root);
+        //节点不需要析构时分配器整块释放，不用遍历
+        if (!nodes.canReleaseAll())
+            destroy(root);
+        nodes.releaseAll();
+        root = nullptr;
         count = 0;
     }
 
 private:
-    /***************************************************************************
-      *  Standard BST search.
-    ***************************************************************************/
-    // insert the key-value pair in the subtree rooted at h
-    Node *add(Node *node, const K &key, const V &value) {
-        if (node == nullptr) {
-            count++;
-            return new Node(key, value);
-        }
-        if (node->key < key) {
-            node->right = add(node->right, key, value);
-        } else if (node->key > key) {
-            node->left = add(node->left, key, value);
-        } else {
-            node->val = value;
-        }
-        return keepBalance(node);
+    static bool isIncreasing(const K *keys, const int len) {
+        for (int i = 1; i < len; i++)
+            if (!(keys[i - 1] < keys[i]))
+                return false;
+        return true;
+    }
+
+    //keys[lo...hi]的中间一个作根，左右子树的大小最多差1，高度也最多差1
+    Node *build(const K *keys, const V *vals, const int lo, const int hi) {
+        if (lo > hi)
+            return nullptr;
+        int mid = lo + (hi - lo) / 2;
+        Node *x = nodes.create(keys[mid], vals[mid]);
+        x->left = build(keys, vals, lo, mid - 1);
+        x->right = build(keys, vals, mid + 1, hi);
+        if (x->left != nullptr) x->left->parent = x;
+        if (x->right != nullptr) x->right->parent = x;
+        x->height = max(height(x->left), height(x->right)) + 1;
+        x->size = hi - lo + 1;
+        return x;
     }
 
     /***************************************************************************
-     *  AVL tree deletion.
+     *  AVL tree insertion and deletion (bottom-up).
      ***************************************************************************/
-    // remove the key-value pair with the minimum key rooted at h
-    Node *removeMin(Node *node) {
-        if (node->left == nullptr) {
-            Node *rightNode = node->right;
-            delete node;
-            count--;
-            return rightNode;
+    // 从p往上更新高度、重新平衡；某个子树的高度没变时，上面祖先的高度和平衡因子都不受影响，提前停下
+    // 插入时最多旋转一次(单旋或双旋)就会停下，删除时可能一直走到根
+    void retrace(Node *p) {
+        while (p != nullptr) {
+            int oldHeight = p->height;
+            Node *sub = keepBalance(p);
+            if (sub->height == oldHeight)
+                break;
+            p = sub->parent;
         }
-        node->left = removeMin(node->left);
-        return keepBalance(node);
     }
 
-    Node *removeMax(Node *node) {
-        if (node == nullptr) {
-            return nullptr;
+    // 删掉节点z：有两个孩子时把后继的键值搬过来，改删后继；摘掉的节点最多一个孩子，由它顶替
+    void removeNode(Node *z) {
+        if (z->left != nullptr && z->right != nullptr) {
+            Node *successor = min(z->right);
+            z->key = successor->key;
+            z->val = successor->val;
+            z = successor;
         }
-        if (node->right == nullptr) {
-            Node *leftNode = node->left;
-            delete node;
-            count--;
-            return leftNode;
-        }
-        node->right = removeMax(node->right);
-        return keepBalance(node);
-    }
-
-    Node *remove(Node *node, const K &key) {
-        if (node->key > key) {
-            node->left = remove(node->left, key);
-        } else if (node->key < key) {
-            node->right = remove(node->right, key);
-        } else if (node->key == key) {
-            if (node->left == nullptr) {
-                Node *rightNode = node->right;
-                delete node;
-                count--;
-                return rightNode;
-            } else {
-                Node *successor = min(node->right);
-                node->key = successor->key;
-                node->val = successor->val;
-                node->right = remove(node->right, successor->key);
-            }
+        Node *parent = z->parent;
+        transplant(z, z->left != nullptr ? z->left : z->right);
+        nodes.destroy(z);
+        count--;
+        retrace(parent);
+    }
+
+    // 用v(可能为空)替换u在父节点里的位置
+    void transplant(Node *u, Node *v) {
+        if (u->parent == nullptr) root = v;
+        else if (u == u->parent->left) u->parent->left = v;
+        else u->parent->right = v;
+        TREE_COUNT_WRITE(links, 1);
+        if (v != nullptr) {
+            v->parent = u->parent;
+            TREE_COUNT_WRITE(links, 1);
         }
-        return keepBalance(node);
     }
 
     /***************************************************************************
@@ -275,6 +381,7 @@ private:
             return nullptr;
         //先更新高度
         node->height = max(height(node->left), height(node->right)) + 1;
+        TREE_COUNT_WRITE(heights, 1);
         // LL 情况
         //        y                              x
         //       / \                           /   \
@@ -306,7 +413,7 @@ private:
         //       / \               / \                   T3  T1 T2  T4
         //      T1   T2           T3 T1
         if (getBalanceFactor(node) > 1 && getBalanceFactor(node->left) < 0) {
-            node->left = leftRotate(node->left);
+            leftRotate(node->left);
             return rightRotate(node);
         }
         // RL 情况
@@ -318,7 +425,7 @@ private:
         //   / \                          / \               T1  T3 T4  T2
         //  T3 T4                        T4 T2
         if (getBalanceFactor(node) < -1 && getBalanceFactor(node->right) > 0) {
-            node->right = rightRotate(node->right);
+            rightRotate(node->right);
             return leftRotate(node);
         }
 
@@ -335,17 +442,23 @@ private:
     //      / \
     //     T3 T4
 
+    // 旋转后x接到y原来的父节点上，父指针一起更新
     Node *leftRotate(Node *y) {
         Node *x = y->right;
         Node *T2 = x->left;
 
         //左旋转
+        transplant(y, x);
         x->left = y;
+        y->parent = x;
         y->right = T2;
+        if (T2 != nullptr) T2->parent = y;
+        TREE_COUNT_WRITE(links, T2 != nullptr ? 4 : 3);
 
         //更新 x y 的值，因为y 在下面，所以先更新 y 的高度值，后更新x的高度值
         y->height = max(height(y->left), height(y->right)) + 1;
         x->height = max(height(x->left), height(x->right)) + 1;
+        TREE_COUNT_WRITE(heights, 2);
         return x;
     }
 
@@ -364,11 +477,16 @@ private:
         Node *x = y->left;
         Node *T3 = x->right;
         //右旋转
+        transplant(y, x);
         x->right = y;
+        y->parent = x;
         y->left = T3;
+        if (T3 != nullptr) T3->parent = y;
+        TREE_COUNT_WRITE(links, T3 != nullptr ? 4 : 3);
         //更新 x y 的值，因为y 在下面，所以先更新 y 的高度值，后更新x的高度值
         y->height = max(height(y->left), height(y->right)) + 1;
         x->height = max(height(x->left), height(x->right)) + 1;
+        TREE_COUNT_WRITE(heights, 2);
         return x;
     }
 
@@ -451,7 +569,7 @@ private:
             return;
         destroy(node->left);
         destroy(node->right);
-        delete node;
+        nodes.destroy(node);
     }
 
     int max(const int &a, const int &b) const {
@@ -466,12 +584,14 @@ public:
         bool sizeConsistent = isSizeConsistent();
         bool RankConsistent = isRankConsistent();
         bool balanced = isBalanced();
+        bool linked = isParentConsistent();
 
         if (!bst) printf("Not in symmetric order\n");
         if (!sizeConsistent) printf("Subtree counts not consistent\n");
         if (!RankConsistent) printf("Ranks not consistent\n");
         if (!balanced) printf("Not balanced\n");
-        return bst && sizeConsistent && RankConsistent && balanced;
+        if (!linked) printf("Parent links not consistent\n");
+        return bst && sizeConsistent && RankConsistent && balanced && linked;
     }
 
     // does this binary tree satisfy symmetric order?
@@ -520,11 +640,25 @@ public:
         int rightHight = isBalanced(node->right);
         if (rightHight < 0)
             return rightHight;
-        if (leftHight - rightHight < 2 || rightHight - leftHight < 2)
+        //高度差不超过1，记录的高度也要对
+        if (leftHight - rightHight < 2 && rightHight - leftHight < 2
+            && node->height == max(leftHight, rightHight) + 1)
             return max(leftHight, rightHight) + 1;
         else
             return -1;
     }
+
+    // does every child point back to its parent?
+    bool isParentConsistent() const {
+        return (root == nullptr || root->parent == nullptr) && isParentConsistent(root);
+    }
+
+    bool isParentConsistent(Node *x) const {
+        if (x == nullptr) return true;
+        if (x->left != nullptr && x->left->parent != x) return false;
+        if (x->right != nullptr && x->right->parent != x) return false;
+        return isParentConsistent(x->left) && isParentConsistent(x->right);
+    }
 };
 
 #endif
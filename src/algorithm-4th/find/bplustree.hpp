@@ -0,0 +1,924 @@
+#ifndef _BPLUS_TREE_H_
+#define _BPLUS_TREE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "allocator.hpp"
+#include "../sort/SortingNetwork.hpp"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace bplustree_simd {
+
+    //节点内的查找：keys[0, n)有序，默认用二分查找
+    template<typename K, typename Enable = void>
+    struct KeySearch {
+        //小于key的个数
+        static int countLess(const K *keys, const int n, const K &key) {
+            return (int) (std::lower_bound(keys, keys + n, key) - keys);
+        }
+
+        //小于等于key的个数
+        static int countLessEqual(const K *keys, const int n, const K &key) {
+            return (int) (std::upper_bound(keys, keys + n, key) - keys);
+        }
+    };
+
+#if SORTING_NETWORK_X86
+
+#define BPLUSTREE_TARGET_AVX2 __attribute__((target("avx2")))
+
+    /*
+     32位和64位有符号整数键用AVX2一次比较8个(4个)，掩码里1的个数就是这一组里满足条件的键数；
+     键是有序的，一组里不是全部满足就可以停下。节点里只有几十个键，比二分查找少了很多难预测的分支。
+     */
+    BPLUSTREE_TARGET_AVX2 inline int countLessInt32(const int32_t *keys, const int n, const int32_t key, bool equal) {
+        __m256i k = _mm256_set1_epi32(key);
+        int count = 0, i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256((const __m256i *) (keys + i));
+            //equal时数 !(v > key)，否则数 key > v
+            __m256i c = equal ? _mm256_andnot_si256(_mm256_cmpgt_epi32(v, k), _mm256_set1_epi32(-1))
+                              : _mm256_cmpgt_epi32(k, v);
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(c));
+            count += __builtin_popcount(mask);
+            if (mask != 0xFF)
+                return count;
+        }
+        for (; i < n && (equal ? !(key < keys[i]) : keys[i] < key); i++)
+            count++;
+        return count;
+    }
+
+    BPLUSTREE_TARGET_AVX2 inline int countLessInt64(const int64_t *keys, const int n, const int64_t key, bool equal) {
+        __m256i k = _mm256_set1_epi64x(key);
+        int count = 0, i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m256i v = _mm256_loadu_si256((const __m256i *) (keys + i));
+            __m256i c = equal ? _mm256_andnot_si256(_mm256_cmpgt_epi64(v, k), _mm256_set1_epi64x(-1))
+                              : _mm256_cmpgt_epi64(k, v);
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(c));
+            count += __builtin_popcount(mask);
+            if (mask != 0xF)
+                return count;
+        }
+        for (; i < n && (equal ? !(key < keys[i]) : keys[i] < key); i++)
+            count++;
+        return count;
+    }
+
+#undef BPLUSTREE_TARGET_AVX2
+
+    template<typename K>
+    struct KeySearch<K, typename std::enable_if<std::is_integral<K>::value && std::is_signed<K>::value
+                                                && (sizeof(K) == 4 || sizeof(K) == 8)>::type> {
+        static int countLess(const K *keys, const int n, const K &key) {
+            return count(keys, n, key, false);
+        }
+
+        static int countLessEqual(const K *keys, const int n, const K &key) {
+            return count(keys, n, key, true);
+        }
+
+    private:
+        static int count(const K *keys, const int n, const K &key, const bool equal) {
+            if (sortingNetworkIsa() < SORTING_NETWORK_AVX2)
+                return equal ? KeySearch<K, bool>::countLessEqual(keys, n, key)
+                             : KeySearch<K, bool>::countLess(keys, n, key);
+            if (sizeof(K) == 4)
+                return countLessInt32(reinterpret_cast<const int32_t *>(keys), n, (int32_t) key, equal);
+            return countLessInt64(reinterpret_cast<const int64_t *>(keys), n, (int64_t) key, equal);
+        }
+    };
+
+#endif //SORTING_NETWORK_X86
+}
+
+#pragma GCC diagnostic pop
+
+/*
+ B+树，接口和RBTree一样(add/get/remove/contains/rank/select/floor/ceiling/min/max...)
+ 二叉树每层一次指针跳转、一次缓存缺失，B+树一个节点NODE_BYTES字节，放几十个键，树高只有log_B(n)：
+   - 内部节点只存分隔键、孩子指针和每个孩子子树的大小(rank/select不用访问孩子)，
+     child[i]里的键都在[keys[i-1], keys[i])之间；
+   - 叶子节点存键和值，前后叶子串成双向链表，迭代器、范围扫描(range)和floor/ceiling跨叶子时顺着链表走；
+   - 节点内用KeySearch查找，整数键用AVX2；
+   - 往最右边的叶子末尾插入时(键递增地插入)不对半分裂，左边的叶子保持满的，新的最右叶子从一个键开始，
+     最右边一条路径上的内部节点也这样分裂；
+   - 删除后节点少于一半时先向兄弟借，借不到就和兄弟合并。
+ */
+template<typename K, typename V, template<typename> class Allocator = HeapAllocator>
+class BPlusTree {
+    /*
+     一个节点大约16个缓存行：100万个随机int键插入、查找、删除一半，256字节比1024字节慢约40%，
+     再大查找省下的缓存缺失就被节点内移动键的开销抵消了
+     */
+    static const int NODE_BYTES = 1024;
+
+    struct Node {
+        int n;          //键的个数，内部节点有n+1个孩子
+        bool leaf;
+    };
+
+    static const int LEAF_CAPACITY = (int) ((NODE_BYTES - 32) / (sizeof(K) + sizeof(V))) > 4
+                                     ? (int) ((NODE_BYTES - 32) / (sizeof(K) + sizeof(V))) : 4;
+    static const int INNER_CAPACITY = (int) ((NODE_BYTES - 24) / (sizeof(K) + sizeof(Node *) + sizeof(int))) > 4
+                                      ? (int) ((NODE_BYTES - 24) / (sizeof(K) + sizeof(Node *) + sizeof(int))) : 4;
+    static const int LEAF_MIN = LEAF_CAPACITY / 2;
+    static const int INNER_MIN = INNER_CAPACITY / 2;
+
+    struct Leaf : Node {
+        Leaf *prev;
+        Leaf *next;
+        K keys[LEAF_CAPACITY];
+        V vals[LEAF_CAPACITY];
+
+        Leaf() : prev(nullptr), next(nullptr) {
+            this->n = 0;
+            this->leaf = true;
+        }
+    };
+
+    struct Inner : Node {
+        K keys[INNER_CAPACITY];
+        Node *child[INNER_CAPACITY + 1];
+        int sizes[INNER_CAPACITY + 1];
+
+        Inner() {
+            this->n = 0;
+            this->leaf = false;
+        }
+    };
+
+    typedef bplustree_simd::KeySearch<K> Search;
+
+    Node *root;
+    Leaf *head;     //最左边的叶子
+    Leaf *tail;     //最右边的叶子
+    int count;
+    int levels;
+    Allocator<Leaf> leaves;
+    Allocator<Inner> inners;
+
+public:
+    //双向只读迭代器，是叶子里的一个位置(leaf, j)，顺着叶子链表前后移动，end时leaf为空；树修改以后失效
+    class iterator {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef K value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const K *pointer;
+        typedef const K &reference;
+
+        iterator() : tree(nullptr), leaf(nullptr), j(0) {}
+
+        reference operator*() const { return leaf->keys[j]; }
+
+        pointer operator->() const { return &leaf->keys[j]; }
+
+        const K &key() const { return leaf->keys[j]; }
+
+        const V &value() const { return leaf->vals[j]; }
+
+        bool operator==(const iterator &that) const { return leaf == that.leaf && j == that.j; }
+
+        bool operator!=(const iterator &that) const { return !(*this == that); }
+
+        iterator &operator++() {
+            if (++j == leaf->n) {
+                leaf = leaf->next;
+                j = 0;
+            }
+            return *this;
+        }
+
+        iterator &operator--() {
+            if (leaf == nullptr) {
+                leaf = tree->tail;
+                j = leaf ? leaf->n - 1 : 0;
+            } else if (j > 0) {
+                j--;
+            } else {
+                leaf = leaf->prev;
+                j = leaf ? leaf->n - 1 : 0;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        iterator operator--(int) {
+            iterator old = *this;
+            --*this;
+            return old;
+        }
+
+    private:
+        friend class BPlusTree;
+
+        const BPlusTree *tree;
+        const Leaf *leaf;
+        int j;
+
+        //j是叶子末尾时移到下一个叶子的开头
+        iterator(const BPlusTree *tree, const Leaf *leaf, const int j) : tree(tree), leaf(leaf), j(j) {
+            if (leaf != nullptr && j == leaf->n) {
+                this->leaf = leaf->next;
+                this->j = 0;
+            }
+        }
+    };
+
+    BPlusTree() : root(nullptr), head(nullptr), tail(nullptr), count(0), levels(0) {}
+
+    ~BPlusTree() { destroy(); }
+
+    BPlusTree(const BPlusTree &) = delete;
+
+    BPlusTree &operator=(const BPlusTree &) = delete;
+
+    int size() const { return count; }
+
+    bool empty() const { return count == 0; }
+
+    bool contains(const K &key) const { return get(key) != nullptr; }
+
+    const V *get(const K &key) const {
+        if (root == nullptr)
+            return nullptr;
+        const Leaf *leaf = findLeaf(key);
+        int j = Search::countLess(leaf->keys, leaf->n, key);
+        if (j < leaf->n && !(key < leaf->keys[j]))
+            return &leaf->vals[j];
+        return nullptr;
+    }
+
+    //已经有这个键时覆盖它的值
+    void add(const K &key, const V &val) {
+        if (root == nullptr) {
+            Leaf *leaf = leaves.create();
+            root = head = tail = leaf;
+            levels = 1;
+        }
+        K splitKey;
+        Node *splitNode;
+        if (insert(root, key, val, true, splitKey, splitNode))
+            count++;
+        if (splitNode != nullptr) {
+            //根分裂，树长高一层
+            Inner *newRoot = inners.create();
+            newRoot->n = 1;
+            newRoot->keys[0] = splitKey;
+            newRoot->child[0] = root;
+            newRoot->child[1] = splitNode;
+            newRoot->sizes[1] = subtreeSize(splitNode);
+            newRoot->sizes[0] = count - newRoot->sizes[1];
+            root = newRoot;
+            levels++;
+        }
+    }
+
+    void remove(const K &key) {
+        if (root == nullptr || !erase(root, key))
+            return;
+        count--;
+        if (!root->leaf && root->n == 0) {
+            //根只剩一个孩子，树变矮一层
+            Inner *old = static_cast<Inner *>(root);
+            root = old->child[0];
+            inners.destroy(old);
+            levels--;
+        } else if (root->leaf && root->n == 0) {
+            leaves.destroy(static_cast<Leaf *>(root));
+            root = head = tail = nullptr;
+            levels = 0;
+        }
+    }
+
+    //树的层数，空树是0，只有一个叶子是1
+    int height() const { return levels; }
+
+    const K *min() const {
+        return head ? &head->keys[0] : nullptr;
+    }
+
+    const K *max() const {
+        return tail ? &tail->keys[tail->n - 1] : nullptr;
+    }
+
+    //小于等于key的最大的键
+    const K *floor(const K &key) const {
+        if (root == nullptr)
+            return nullptr;
+        const Leaf *leaf = findLeaf(key);
+        int j = Search::countLessEqual(leaf->keys, leaf->n, key);
+        if (j > 0)
+            return &leaf->keys[j - 1];
+        return leaf->prev ? &leaf->prev->keys[leaf->prev->n - 1] : nullptr;
+    }
+
+    //大于等于key的最小的键
+    const K *ceiling(const K &key) const {
+        if (root == nullptr)
+            return nullptr;
+        const Leaf *leaf = findLeaf(key);
+        int j = Search::countLess(leaf->keys, leaf->n, key);
+        if (j < leaf->n)
+            return &leaf->keys[j];
+        return leaf->next ? &leaf->next->keys[0] : nullptr;
+    }
+
+    //第rank小(从0开始)的键
+    const K *select(int rank) const {
+        if (rank < 0 || rank >= count)
+            return nullptr;
+        const Node *x = root;
+        while (!x->leaf) {
+            const Inner *inner = static_cast<const Inner *>(x);
+            int i = 0;
+            while (rank >= inner->sizes[i])
+                rank -= inner->sizes[i++];
+            x = inner->child[i];
+        }
+        return &static_cast<const Leaf *>(x)->keys[rank];
+    }
+
+    //小于key的键的个数
+    int rank(const K &key) const {
+        if (root == nullptr)
+            return 0;
+        int r = 0;
+        const Node *x = root;
+        while (!x->leaf) {
+            const Inner *inner = static_cast<const Inner *>(x);
+            int i = Search::countLessEqual(inner->keys, inner->n, key);
+            for (int c = 0; c < i; c++)
+                r += inner->sizes[c];
+            x = inner->child[i];
+        }
+        const Leaf *leaf = static_cast<const Leaf *>(x);
+        return r + Search::countLess(leaf->keys, leaf->n, key);
+    }
+
+    void removeMin() {
+        if (head != nullptr) {
+            K key = head->keys[0];
+            remove(key);
+        }
+    }
+
+    void removeMax() {
+        if (tail != nullptr) {
+            K key = tail->keys[tail->n - 1];
+            remove(key);
+        }
+    }
+
+    iterator begin() const { return iterator(this, head, 0); }
+
+    iterator end() const { return iterator(this, nullptr, 0); }
+
+    //第一个大于等于key的位置
+    iterator lowerBound(const K &key) const {
+        if (root == nullptr)
+            return end();
+        const Leaf *leaf = findLeaf(key);
+        return iterator(this, leaf, Search::countLess(leaf->keys, leaf->n, key));
+    }
+
+    //第一个大于key的位置
+    iterator upperBound(const K &key) const {
+        if (root == nullptr)
+            return end();
+        const Leaf *leaf = findLeaf(key);
+        return iterator(this, leaf, Search::countLessEqual(leaf->keys, leaf->n, key));
+    }
+
+    //按顺序访问[lo, hi]里的每一对键值，visit(key, val)，从lo所在的叶子开始顺着链表往后走
+    template<typename F>
+    void range(const K &lo, const K &hi, F visit) const {
+        if (root == nullptr)
+            return;
+        const Leaf *leaf = findLeaf(lo);
+        int j = Search::countLess(leaf->keys, leaf->n, lo);
+        for (; leaf != nullptr; leaf = leaf->next, j = 0) {
+            for (; j < leaf->n; j++) {
+                if (hi < leaf->keys[j])
+                    return;
+                visit(leaf->keys[j], leaf->vals[j]);
+            }
+        }
+    }
+
+    /*
+     用有序的keys[0, len)、vals[0, len)自底向上建树，O(n)，树里原来的键值都清掉：
+     键平均分到ceil(len/LEAF_CAPACITY)个叶子里，再一层一层地把孩子平均分给父节点，节点都在半满以上
+     键要严格递增；不是的话退化成逐个add
+     */
+    void bulkLoad(const K *keys, const V *vals, const int len) {
+        destroy();
+        if (!isIncreasing(keys, len)) {
+            for (int i = 0; i < len; i++)
+                add(keys[i], vals[i]);
+            return;
+        }
+        if (len == 0)
+            return;
+        //当前这一层的节点、每个节点子树里最小的键(父节点里的分隔键)和子树大小
+        std::vector<Node *> level;
+        std::vector<const K *> firsts;
+        std::vector<int> sizes;
+        const int leafCount = (len + LEAF_CAPACITY - 1) / LEAF_CAPACITY;
+        Leaf *prev = nullptr;
+        for (int l = 0; l < leafCount; l++) {
+            const int begin = (int) ((long long) len * l / leafCount);
+            const int end = (int) ((long long) len * (l + 1) / leafCount);
+            Leaf *leaf = leaves.create();
+            std::copy(keys + begin, keys + end, leaf->keys);
+            std::copy(vals + begin, vals + end, leaf->vals);
+            leaf->n = end - begin;
+            leaf->prev = prev;
+            if (prev)
+                prev->next = leaf;
+            else
+                head = leaf;
+            prev = leaf;
+            level.push_back(leaf);
+            firsts.push_back(keys + begin);
+            sizes.push_back(leaf->n);
+        }
+        tail = prev;
+        levels = 1;
+        while (level.size() > 1) {
+            const int children = (int) level.size();
+            const int parents = (children + INNER_CAPACITY) / (INNER_CAPACITY + 1);
+            std::vector<Node *> upper;
+            std::vector<const K *> upperFirsts;
+            std::vector<int> upperSizes;
+            for (int p = 0; p < parents; p++) {
+                const int begin = (int) ((long long) children * p / parents);
+                const int end = (int) ((long long) children * (p + 1) / parents);
+                Inner *inner = inners.create();
+                inner->n = end - begin - 1;
+                int size = 0;
+                for (int c = begin; c < end; c++) {
+                    if (c > begin)
+                        inner->keys[c - begin - 1] = *firsts[c];
+                    inner->child[c - begin] = level[c];
+                    inner->sizes[c - begin] = sizes[c];
+                    size += sizes[c];
+                }
+                upper.push_back(inner);
+                upperFirsts.push_back(firsts[begin]);
+                upperSizes.push_back(size);
+            }
+            level.swap(upper);
+            firsts.swap(upperFirsts);
+            sizes.swap(upperSizes);
+            levels++;
+        }
+        root = level[0];
+        count = len;
+    }
+
+    //有序的keys/vals和树里已有的键值归并之后重建，键相同时用新的值，O(n + size())，顺着叶子链表读出已有的键值
+    void bulkMerge(const K *keys, const V *vals, const int len) {
+        if (!isIncreasing(keys, len)) {
+            for (int i = 0; i < len; i++)
+                add(keys[i], vals[i]);
+            return;
+        }
+        std::vector<K> mergedKeys;
+        std::vector<V> mergedVals;
+        mergedKeys.reserve(count + len);
+        mergedVals.reserve(count + len);
+        int i = 0;
+        for (const Leaf *leaf = head; leaf != nullptr; leaf = leaf->next) {
+            for (int j = 0; j < leaf->n; j++) {
+                for (; i < len && keys[i] < leaf->keys[j]; i++) {
+                    mergedKeys.push_back(keys[i]);
+                    mergedVals.push_back(vals[i]);
+                }
+                mergedKeys.push_back(leaf->keys[j]);
+                if (i < len && !(leaf->keys[j] < keys[i]))
+                    mergedVals.push_back(vals[i++]);
+                else
+                    mergedVals.push_back(leaf->vals[j]);
+            }
+        }
+        for (; i < len; i++) {
+            mergedKeys.push_back(keys[i]);
+            mergedVals.push_back(vals[i]);
+        }
+        bulkLoad(mergedKeys.data(), mergedVals.data(), (int) mergedKeys.size());
+    }
+
+    void destroy() {
+        //节点不需要析构时分配器整块释放，不用遍历
+        if (!leaves.canReleaseAll() || !inners.canReleaseAll())
+            destroy(root);
+        leaves.releaseAll();
+        inners.releaseAll();
+        root = head = tail = nullptr;
+        count = 0;
+        levels = 0;
+    }
+
+private:
+    static bool isIncreasing(const K *keys, const int len) {
+        for (int i = 1; i < len; i++)
+            if (!(keys[i - 1] < keys[i]))
+                return false;
+        return true;
+    }
+
+    static int subtreeSize(const Node *x) {
+        if (x->leaf)
+            return x->n;
+        const Inner *inner = static_cast<const Inner *>(x);
+        int size = 0;
+        for (int i = 0; i <= inner->n; i++)
+            size += inner->sizes[i];
+        return size;
+    }
+
+    const Leaf *findLeaf(const K &key) const {
+        const Node *x = root;
+        while (!x->leaf) {
+            const Inner *inner = static_cast<const Inner *>(x);
+            x = inner->child[Search::countLessEqual(inner->keys, inner->n, key)];
+        }
+        return static_cast<const Leaf *>(x);
+    }
+
+    /*
+     把key插入以x为根的子树，返回是否新增了一个键
+     x分裂时splitNode是新的右兄弟，splitKey是右兄弟里最小的键(作为父节点里的分隔键)，否则splitNode为空
+     rightEdge表示x在树的最右边一条路径上
+     */
+    bool insert(Node *x, const K &key, const V &val, const bool rightEdge, K &splitKey, Node *&splitNode) {
+        splitNode = nullptr;
+        if (x->leaf)
+            return insertLeaf(static_cast<Leaf *>(x), key, val, splitKey, splitNode);
+        Inner *inner = static_cast<Inner *>(x);
+        int i = Search::countLessEqual(inner->keys, inner->n, key);
+        K childKey;
+        Node *childSplit;
+        bool append = rightEdge && i == inner->n;
+        bool inserted = insert(inner->child[i], key, val, append, childKey, childSplit);
+        if (inserted)
+            inner->sizes[i]++;
+        if (childSplit != nullptr)
+            insertChild(inner, i, childKey, childSplit, append, splitKey, splitNode);
+        return inserted;
+    }
+
+    bool insertLeaf(Leaf *leaf, const K &key, const V &val, K &splitKey, Node *&splitNode) {
+        int j = Search::countLess(leaf->keys, leaf->n, key);
+        if (j < leaf->n && !(key < leaf->keys[j])) {
+            leaf->vals[j] = val;
+            return false;
+        }
+        if (leaf->n < LEAF_CAPACITY) {
+            insertAt(leaf, j, key, val);
+            return true;
+        }
+        //满了，分裂成两个叶子：一共LEAF_CAPACITY+1个键，左边留leftCount个
+        int leftCount = (LEAF_CAPACITY + 1) / 2;
+        if (j == leaf->n && leaf->next == nullptr)
+            leftCount = LEAF_CAPACITY;
+        Leaf *right = leaves.create();
+        int from = j < leftCount ? leftCount - 1 : leftCount;
+        for (int k = from; k < leaf->n; k++) {
+            right->keys[k - from] = std::move(leaf->keys[k]);
+            right->vals[k - from] = std::move(leaf->vals[k]);
+        }
+        right->n = leaf->n - from;
+        leaf->n = from;
+        if (j < leftCount)
+            insertAt(leaf, j, key, val);
+        else
+            insertAt(right, j - from, key, val);
+
+        right->next = leaf->next;
+        right->prev = leaf;
+        if (leaf->next)
+            leaf->next->prev = right;
+        else
+            tail = right;
+        leaf->next = right;
+        splitKey = right->keys[0];
+        splitNode = right;
+        return true;
+    }
+
+    static void insertAt(Leaf *leaf, const int j, const K &key, const V &val) {
+        for (int k = leaf->n; k > j; k--) {
+            leaf->keys[k] = std::move(leaf->keys[k - 1]);
+            leaf->vals[k] = std::move(leaf->vals[k - 1]);
+        }
+        leaf->keys[j] = key;
+        leaf->vals[j] = val;
+        leaf->n++;
+    }
+
+    //child[i]分裂出了right，分隔键sep插到keys[i]、right插到child[i+1]；inner满了就再分裂，append时和叶子一样左边留满
+    void insertChild(Inner *inner, const int i, const K &sep, Node *right, const bool append,
+                     K &splitKey, Node *&splitNode) {
+        int rightSize = subtreeSize(right);
+        int leftSize = inner->sizes[i] - rightSize;
+        if (inner->n < INNER_CAPACITY) {
+            for (int k = inner->n; k > i; k--) {
+                inner->keys[k] = std::move(inner->keys[k - 1]);
+                inner->child[k + 1] = inner->child[k];
+                inner->sizes[k + 1] = inner->sizes[k];
+            }
+            inner->keys[i] = sep;
+            inner->child[i + 1] = right;
+            inner->sizes[i] = leftSize;
+            inner->sizes[i + 1] = rightSize;
+            inner->n++;
+            return;
+        }
+        //先在临时数组里插好，一共INNER_CAPACITY+1个键，中间的键上移到父节点
+        K keys[INNER_CAPACITY + 1];
+        Node *child[INNER_CAPACITY + 2];
+        int sizes[INNER_CAPACITY + 2];
+        for (int k = 0, t = 0; k < inner->n; k++, t++) {
+            if (k == i)
+                keys[t++] = sep;
+            keys[t] = std::move(inner->keys[k]);
+        }
+        if (i == inner->n)
+            keys[inner->n] = sep;
+        for (int k = 0, t = 0; k <= inner->n; k++, t++) {
+            child[t] = inner->child[k];
+            sizes[t] = inner->sizes[k];
+            if (k == i) {
+                sizes[t] = leftSize;
+                child[++t] = right;
+                sizes[t] = rightSize;
+            }
+        }
+        const int total = INNER_CAPACITY + 1;
+        const int mid = append ? total - 2 : total / 2;
+        Inner *sibling = inners.create();
+        inner->n = mid;
+        for (int k = 0; k < mid; k++)
+            inner->keys[k] = std::move(keys[k]);
+        for (int k = 0; k <= mid; k++) {
+            inner->child[k] = child[k];
+            inner->sizes[k] = sizes[k];
+        }
+        sibling->n = total - mid - 1;
+        for (int k = 0; k < sibling->n; k++)
+            sibling->keys[k] = std::move(keys[mid + 1 + k]);
+        for (int k = 0; k <= sibling->n; k++) {
+            sibling->child[k] = child[mid + 1 + k];
+            sibling->sizes[k] = sizes[mid + 1 + k];
+        }
+        splitKey = std::move(keys[mid]);
+        splitNode = sibling;
+    }
+
+    //从以x为根的子树删除key，返回是否删除了；孩子少于一半时调整
+    bool erase(Node *x, const K &key) {
+        if (x->leaf) {
+            Leaf *leaf = static_cast<Leaf *>(x);
+            int j = Search::countLess(leaf->keys, leaf->n, key);
+            if (j == leaf->n || key < leaf->keys[j])
+                return false;
+            for (int k = j + 1; k < leaf->n; k++) {
+                leaf->keys[k - 1] = std::move(leaf->keys[k]);
+                leaf->vals[k - 1] = std::move(leaf->vals[k]);
+            }
+            leaf->n--;
+            return true;
+        }
+        Inner *inner = static_cast<Inner *>(x);
+        int i = Search::countLessEqual(inner->keys, inner->n, key);
+        if (!erase(inner->child[i], key))
+            return false;
+        inner->sizes[i]--;
+        Node *c = inner->child[i];
+        if (c->n < (c->leaf ? LEAF_MIN : INNER_MIN))
+            rebalance(inner, i);
+        return true;
+    }
+
+    static bool canLend(const Node *x) {
+        return x->n > (x->leaf ? LEAF_MIN : INNER_MIN);
+    }
+
+    void rebalance(Inner *parent, const int i) {
+        if (i > 0 && canLend(parent->child[i - 1]))
+            borrowFromLeft(parent, i);
+        else if (i < parent->n && canLend(parent->child[i + 1]))
+            borrowFromRight(parent, i);
+        else if (i > 0)
+            merge(parent, i - 1);
+        else
+            merge(parent, i);
+    }
+
+    //child[i-1]的最后一个键挪给child[i]
+    void borrowFromLeft(Inner *parent, const int i) {
+        int moved;
+        if (parent->child[i]->leaf) {
+            Leaf *left = static_cast<Leaf *>(parent->child[i - 1]);
+            Leaf *right = static_cast<Leaf *>(parent->child[i]);
+            insertAt(right, 0, left->keys[left->n - 1], left->vals[left->n - 1]);
+            left->n--;
+            parent->keys[i - 1] = right->keys[0];
+            moved = 1;
+        } else {
+            Inner *left = static_cast<Inner *>(parent->child[i - 1]);
+            Inner *right = static_cast<Inner *>(parent->child[i]);
+            for (int k = right->n; k > 0; k--) {
+                right->keys[k] = std::move(right->keys[k - 1]);
+                right->child[k + 1] = right->child[k];
+                right->sizes[k + 1] = right->sizes[k];
+            }
+            right->child[1] = right->child[0];
+            right->sizes[1] = right->sizes[0];
+            right->keys[0] = std::move(parent->keys[i - 1]);
+            right->child[0] = left->child[left->n];
+            right->sizes[0] = left->sizes[left->n];
+            parent->keys[i - 1] = std::move(left->keys[left->n - 1]);
+            right->n++;
+            left->n--;
+            moved = right->sizes[0];
+        }
+        parent->sizes[i - 1] -= moved;
+        parent->sizes[i] += moved;
+    }
+
+    //child[i+1]的第一个键挪给child[i]
+    void borrowFromRight(Inner *parent, const int i) {
+        int moved;
+        if (parent->child[i]->leaf) {
+            Leaf *left = static_cast<Leaf *>(parent->child[i]);
+            Leaf *right = static_cast<Leaf *>(parent->child[i + 1]);
+            left->keys[left->n] = std::move(right->keys[0]);
+            left->vals[left->n] = std::move(right->vals[0]);
+            left->n++;
+            for (int k = 1; k < right->n; k++) {
+                right->keys[k - 1] = std::move(right->keys[k]);
+                right->vals[k - 1] = std::move(right->vals[k]);
+            }
+            right->n--;
+            parent->keys[i] = right->keys[0];
+            moved = 1;
+        } else {
+            Inner *left = static_cast<Inner *>(parent->child[i]);
+            Inner *right = static_cast<Inner *>(parent->child[i + 1]);
+            left->keys[left->n] = std::move(parent->keys[i]);
+            left->child[left->n + 1] = right->child[0];
+            left->sizes[left->n + 1] = right->sizes[0];
+            left->n++;
+            parent->keys[i] = std::move(right->keys[0]);
+            for (int k = 1; k < right->n; k++)
+                right->keys[k - 1] = std::move(right->keys[k]);
+            for (int k = 1; k <= right->n; k++) {
+                right->child[k - 1] = right->child[k];
+                right->sizes[k - 1] = right->sizes[k];
+            }
+            right->n--;
+            moved = left->sizes[left->n];
+        }
+        parent->sizes[i] += moved;
+        parent->sizes[i + 1] -= moved;
+    }
+
+    //child[i+1]并到child[i]里，去掉分隔键keys[i]
+    void merge(Inner *parent, const int i) {
+        if (parent->child[i]->leaf) {
+            Leaf *left = static_cast<Leaf *>(parent->child[i]);
+            Leaf *right = static_cast<Leaf *>(parent->child[i + 1]);
+            for (int k = 0; k < right->n; k++) {
+                left->keys[left->n + k] = std::move(right->keys[k]);
+                left->vals[left->n + k] = std::move(right->vals[k]);
+            }
+            left->n += right->n;
+            left->next = right->next;
+            if (right->next)
+                right->next->prev = left;
+            else
+                tail = left;
+            leaves.destroy(right);
+        } else {
+            Inner *left = static_cast<Inner *>(parent->child[i]);
+            Inner *right = static_cast<Inner *>(parent->child[i + 1]);
+            left->keys[left->n] = std::move(parent->keys[i]);
+            for (int k = 0; k < right->n; k++)
+                left->keys[left->n + 1 + k] = std::move(right->keys[k]);
+            for (int k = 0; k <= right->n; k++) {
+                left->child[left->n + 1 + k] = right->child[k];
+                left->sizes[left->n + 1 + k] = right->sizes[k];
+            }
+            left->n += 1 + right->n;
+            inners.destroy(right);
+        }
+        parent->sizes[i] += parent->sizes[i + 1];
+        for (int k = i + 1; k < parent->n; k++) {
+            parent->keys[k - 1] = std::move(parent->keys[k]);
+            parent->child[k] = parent->child[k + 1];
+            parent->sizes[k] = parent->sizes[k + 1];
+        }
+        parent->n--;
+    }
+
+    void destroy(Node *x) {
+        if (x == nullptr)
+            return;
+        if (x->leaf) {
+            leaves.destroy(static_cast<Leaf *>(x));
+            return;
+        }
+        Inner *inner = static_cast<Inner *>(x);
+        for (int i = 0; i <= inner->n; i++)
+            destroy(inner->child[i]);
+        inners.destroy(inner);
+    }
+
+    /***************************************************************************
+     *  Check integrity of B+ tree data structure.
+     ***************************************************************************/
+public:
+    bool check() {
+        int leafDepth = -1;
+        bool ordered = true, sized = true, filled = true, balanced = true;
+        int total = root ? checkNode(root, nullptr, nullptr, 1, leafDepth, ordered, sized, filled, balanced) : 0;
+        bool linked = isLinked();
+        bool counted = total == count && (root ? leafDepth == levels : levels == 0);
+
+        if (!ordered) printf("Not in symmetric order\n");
+        if (!sized) printf("Subtree counts not consistent\n");
+        if (!filled) printf("Node less than half full\n");
+        if (!balanced) printf("Leaves not at the same depth\n");
+        if (!linked) printf("Leaf chain broken\n");
+        if (!counted) printf("Size or height not consistent\n");
+        return ordered && sized && filled && balanced && linked && counted;
+    }
+
+private:
+    //检查以x为根的子树，键都在[lo, hi)里，返回子树里键的个数
+    int checkNode(const Node *x, const K *lo, const K *hi, const int depth, int &leafDepth,
+                  bool &ordered, bool &sized, bool &filled, bool &balanced) const {
+        //顺序插入时最右边一条路径上分裂出的节点可以不到一半(hi为空)，它们只会在末尾继续变满
+        if (x != root && hi != nullptr && x->n < (x->leaf ? LEAF_MIN : INNER_MIN))
+            filled = false;
+        const K *keys = x->leaf ? static_cast<const Leaf *>(x)->keys : static_cast<const Inner *>(x)->keys;
+        for (int i = 0; i < x->n; i++) {
+            if (i > 0 && !(keys[i - 1] < keys[i]))
+                ordered = false;
+            if ((lo && keys[i] < *lo) || (hi && !(keys[i] < *hi)))
+                ordered = false;
+        }
+        if (x->leaf) {
+            if (leafDepth < 0)
+                leafDepth = depth;
+            else if (leafDepth != depth)
+                balanced = false;
+            return x->n;
+        }
+        const Inner *inner = static_cast<const Inner *>(x);
+        int total = 0;
+        for (int i = 0; i <= inner->n; i++) {
+            const K *childLo = i > 0 ? &inner->keys[i - 1] : lo;
+            const K *childHi = i < inner->n ? &inner->keys[i] : hi;
+            int size = checkNode(inner->child[i], childLo, childHi, depth + 1, leafDepth,
+                                 ordered, sized, filled, balanced);
+            if (size != inner->sizes[i])
+                sized = false;
+            total += size;
+        }
+        return total;
+    }
+
+    //叶子链表从head到tail按顺序串起了所有的键
+    bool isLinked() const {
+        int total = 0;
+        const Leaf *prev = nullptr;
+        for (const Leaf *leaf = head; leaf != nullptr; prev = leaf, leaf = leaf->next) {
+            if (leaf->prev != prev)
+                return false;
+            if (prev && prev->n > 0 && leaf->n > 0 && !(prev->keys[prev->n - 1] < leaf->keys[0]))
+                return false;
+            total += leaf->n;
+        }
+        return prev == tail && total == count;
+    }
+};
+
+#endif
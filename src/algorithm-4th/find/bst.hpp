@@ -3,8 +3,13 @@
 
 
 #include <cstdio>
+#include <vector>
 
-template<typename K, typename V>
+#include "allocator.hpp"
+#include "tree-iterator.hpp"
+
+//Allocator是节点的分配策略，见allocator.hpp
+template<typename K, typename V, template<typename> class Allocator = HeapAllocator>
 class BSTree {
     struct Node {
         K key;           // key
@@ -18,6 +23,7 @@ class BSTree {
 
     Node *root;     // root of the BST
     int count;
+    Allocator<Node> nodes;
 
 public:
     /**
@@ -81,18 +87,25 @@ public:
      */
     void add(const K &key, const V &val) {
         if (root == nullptr) {
-            root = new Node(key, val);
+            root = nodes.create(key, val);
         } else {
             Node *par = nullptr;
             Node *cur = root;
             while (cur != nullptr) {
                 par = cur;
-                cur = (cur->val > val) ? cur->left : cur->right;
+                if (key < cur->key) {
+                    cur = cur->left;
+                } else if (cur->key < key) {
+                    cur = cur->right;
+                } else {
+                    cur->val = val;
+                    return;
+                }
             }
-            if (par->val > val)
-                par->left = new Node(key, val);
+            if (key < par->key)
+                par->left = nodes.create(key, val);
             else
-                par->right = new Node(key, val);
+                par->right = nodes.create(key, val);
         }
         count++;
 
@@ -219,12 +232,107 @@ public:
         // assert (check());
     }
 
+    typedef TreeIterator<Node, K, V> iterator;
+
+    iterator begin() const { return iterator::first(root); }
+
+    iterator end() const { return iterator(root); }
+
+    //第一个大于等于key的位置
+    iterator lowerBound(const K &key) const { return iterator::lowerBound(root, key); }
+
+    //第一个大于key的位置
+    iterator upperBound(const K &key) const { return iterator::upperBound(root, key); }
+
+    //按顺序访问[lo, hi]里的每一对键值，visit(key, val)，O(log n + k)
+    template<typename F>
+    void range(const K &lo, const K &hi, F visit) const {
+        const iterator last = end();
+        for (iterator it = lowerBound(lo); it != last && !(hi < *it); ++it)
+            visit(it.key(), it.value());
+    }
+
+    /*
+     用有序的keys[0, len)、vals[0, len)直接建一棵完全平衡的树，O(n)，树里原来的键值都清掉
+     键要严格递增；不是的话退化成逐个add，结果一样，只是慢(按顺序add会退化成链表)
+     */
+    void bulkLoad(const K *keys, const V *vals, const int len) {
+        destroy();
+        if (!isIncreasing(keys, len)) {
+            for (int i = 0; i < len; i++)
+                add(keys[i], vals[i]);
+            return;
+        }
+        root = build(keys, vals, 0, len - 1);
+        count = len;
+    }
+
+    //有序的keys/vals和树里已有的键值归并之后重建，键相同时用新的值，O(n + size())
+    void bulkMerge(const K *keys, const V *vals, const int len) {
+        if (!isIncreasing(keys, len)) {
+            for (int i = 0; i < len; i++)
+                add(keys[i], vals[i]);
+            return;
+        }
+        std::vector<K> mergedKeys;
+        std::vector<V> mergedVals;
+        mergedKeys.reserve(count + len);
+        mergedVals.reserve(count + len);
+        //中序遍历用显式的栈，退化的树也不会栈溢出
+        std::vector<Node *> stack;
+        Node *x = root;
+        int i = 0;
+        while (x != nullptr || !stack.empty()) {
+            for (; x != nullptr; x = x->left)
+                stack.push_back(x);
+            x = stack.back();
+            stack.pop_back();
+            for (; i < len && keys[i] < x->key; i++) {
+                mergedKeys.push_back(keys[i]);
+                mergedVals.push_back(vals[i]);
+            }
+            mergedKeys.push_back(x->key);
+            if (i < len && !(x->key < keys[i]))
+                mergedVals.push_back(vals[i++]);
+            else
+                mergedVals.push_back(x->val);
+            x = x->right;
+        }
+        for (; i < len; i++) {
+            mergedKeys.push_back(keys[i]);
+            mergedVals.push_back(vals[i]);
+        }
+        bulkLoad(mergedKeys.data(), mergedVals.data(), (int) mergedKeys.size());
+    }
+
     void destroy() {
-        destroy(root);
+        //节点不需要析构时分配器整块释放，不用遍历
+        if (!nodes.canReleaseAll())
+            destroy(root);
+        nodes.releaseAll();
+        root = nullptr;
         count = 0;
     }
 
 private:
+    static bool isIncreasing(const K *keys, const int len) {
+        for (int i = 1; i < len; i++)
+            if (!(keys[i - 1] < keys[i]))
+                return false;
+        return true;
+    }
+
+    //keys[lo...hi]的中间一个作根，两边递归，左右子树的大小最多差1
+    Node *build(const K *keys, const V *vals, const int lo, const int hi) {
+        if (lo > hi)
+            return nullptr;
+        int mid = lo + (hi - lo) / 2;
+        Node *x = nodes.create(keys[mid], vals[mid]);
+        x->left = build(keys, vals, lo, mid - 1);
+        x->right = build(keys, vals, mid + 1, hi);
+        return x;
+    }
+
     /***************************************************************************
      *  Standard BST search.
      ***************************************************************************/
@@ -235,7 +343,7 @@ private:
     Node *add(Node *h, const K &key, const V &val) {
         if (h == nullptr) {
             count++;
-            return new Node(key, val);
+            return nodes.create(key, val);
         }
         if (key < h->key) h->left = add(h->left, key, val);
         else if (key > h->key) h->right = add(h->right, key, val);
@@ -253,7 +361,7 @@ private:
             return nullptr;
         if (h->left == nullptr) {
             Node *rightNode = h->right;
-            delete h;
+            nodes.destroy(h);
             count--;
             return rightNode;
         }
@@ -267,7 +375,7 @@ private:
             return nullptr;
         if (h->right == nullptr) {
             Node *leftNode = h->left;
-            delete h;
+            nodes.destroy(h);
             count--;
             return leftNode;
         }
@@ -286,9 +394,14 @@ private:
         } else if (node->key == key) {
             if (node->left == nullptr) {
                 Node *rightNode = node->right;
-                delete node;
+                nodes.destroy(node);
                 count--;
                 return rightNode;
+            } else if (node->right == nullptr) {
+                Node *leftNode = node->left;
+                nodes.destroy(node);
+                count--;
+                return leftNode;
             } else {
                 Node *successor = min(node->right);
                 node->key = successor->key;
@@ -379,7 +492,7 @@ private:
             return;
         destroy(node->left);
         destroy(node->right);
-        delete node;
+        nodes.destroy(node);
     }
 
     int max(const int &a, const int &b) const {
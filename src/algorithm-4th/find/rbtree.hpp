@@ -1,7 +1,23 @@
 #ifndef _RBT_TREE_H_
 #define _RBT_TREE_H_
 
-template<typename K, typename V>
+#include <cstdio>
+#include <vector>
+
+#include "allocator.hpp"
+#include "tree-iterator.hpp"
+#include "tree-stats.hpp"
+
+/*
+ 红黑树，插入和删除是非递归、自底向上的(算法导论第13章)：
+   - 节点有父指针，先找到位置插入或删掉节点，再从那里往上修复，插入最多旋转2次，删除最多3次，
+     只有变色一直往上传时才会走到根；
+   - 没有左倾的限制，右孩子也可以是红的，比左倾红黑树少了很多为保持左倾做的旋转；
+   - 每个节点记着子树大小(rank/select用)，插入删除后沿父指针把路径上的大小更新一遍。
+ 左倾红黑树的递归版本在llrbtree.hpp里
+ Allocator是节点的分配策略，见allocator.hpp
+ */
+template<typename K, typename V, template<typename> class Allocator = HeapAllocator>
 class RBTree {
     static const bool RED = true;
     static const bool BLACK = false;
@@ -11,15 +27,20 @@ class RBTree {
         V val;         // associated data
         Node *left;
         Node *right;  // links to left and right subtrees
-        bool color;     // color of parent link
+        Node *parent;
+        bool color;     // color of the node
         int size;          // subtree count
 
-        Node(const K &k, const V &v, bool color, int size) : key(k), val(v), color(color), size(size),
+        Node(const K &k, const V &v, bool color, int size) : key(k), val(v),
                                                              left(nullptr),
-                                                             right(nullptr) {}
+                                                             right(nullptr),
+                                                             parent(nullptr),
+                                                             color(color), size(size) {}
     };
 
     Node *root;     // root of the BST
+    Allocator<Node> nodes;
+    TreeWriteCount writes;
 public:
     /**
      * Initializes an empty symbol table.
@@ -79,8 +100,29 @@ public:
      * @throws IllegalArgumentException if {@code key} is {@code nullptr}
      */
     void add(const K &key, const V &val) {
-        root = add(root, key, val);
-        root->color = BLACK;
+        Node *parent = nullptr;
+        Node *x = root;
+        while (x != nullptr) {
+            parent = x;
+            if (key < x->key) x = x->left;
+            else if (x->key < key) x = x->right;
+            else {
+                //已有这个键只改值，树的结构不变
+                x->val = val;
+                return;
+            }
+        }
+        Node *z = nodes.create(key, val, RED, 1);
+        z->parent = parent;
+        if (parent == nullptr) root = z;
+        else if (key < parent->key) parent->left = z;
+        else parent->right = z;
+        TREE_COUNT_WRITE(links, 2);
+        for (Node *p = parent; p != nullptr; p = p->parent) {
+            p->size++;
+            TREE_COUNT_WRITE(sizes, 1);
+        }
+        addFixup(z);
         // assert (check());
     }
 
@@ -92,13 +134,9 @@ public:
      * @throws IllegalArgumentException if {@code key} is {@code nullptr}
      */
     void remove(const K &key) {
-        if (getNode(root, key) == nullptr) return;
-        // if both children of root are black, set root to red
-        if (!isRed(root->left) && !isRed(root->right))
-            root->color = RED;
-
-        root = remove(root, key);
-        if (!empty()) root->color = BLACK;
+        Node *z = getNode(root, key);
+        if (z == nullptr) return;
+        removeNode(z);
         // assert (check());
     }
 
@@ -194,12 +232,7 @@ public:
      * @throws NoSuchElementException if the symbol table is empty
      */
     void removeMin() {
-        // if both children of root are black, set root to red
-        if (!isRed(root->left) && !isRed(root->right))
-            root->color = RED;
-
-        root = removeMin(root);
-        if (!empty()) root->color = BLACK;
+        if (root != nullptr) removeNode(min(root));
         // assert (check());
     }
 
@@ -209,194 +242,364 @@ public:
      * @throws NoSuchElementException if the symbol table is empty
      */
     void removeMax() {
-        // if both children of root are black, set root to red
-        if (!isRed(root->left) && !isRed(root->right))
-            root->color = RED;
-
-        root = removeMax(root);
-        if (!empty()) root->color = BLACK;
+        if (root != nullptr) removeNode(max(root));
         // assert (check());
     }
 
-    void destroy() {
-        destroy(root);
-    }
+    //定义了TREE_COUNT_WRITES时add/remove写节点的次数，见tree-stats.hpp
+    const TreeWriteCount &writeCount() const { return writes; }
 
-private:
-    /***************************************************************************
-     *  Standard BST search.
-     ***************************************************************************/
-    // insert the key-value pair in the subtree rooted at h
-    Node *add(Node *h, const K &key, const V &val) {
-        if (h == nullptr) return new Node(key, val, RED, 1);
+    void resetWriteCount() { writes = TreeWriteCount(); }
+
+    typedef TreeIterator<Node, K, V> iterator;
+
+    iterator begin() const { return iterator::first(root); }
 
-        if (key < h->key) h->left = add(h->left, key, val);
-        else if (key > h->key) h->right = add(h->right, key, val);
-        else h->val = val;
+    iterator end() const { return iterator(root); }
 
-        // fix-up any right-leaning links
-        if (isRed(h->right) && !isRed(h->left)) h = rotateLeft(h);
-        if (isRed(h->left) && isRed(h->left->left)) h = rotateRight(h);
-        if (isRed(h->left) && isRed(h->right)) flipColors(h);
-        h->size = size(h->left) + size(h->right) + 1;
+    //第一个大于等于key的位置
+    iterator lowerBound(const K &key) const { return iterator::lowerBound(root, key); }
 
-        return h;
+    //第一个大于key的位置
+    iterator upperBound(const K &key) const { return iterator::upperBound(root, key); }
+
+    //按顺序访问[lo, hi]里的每一对键值，visit(key, val)，O(log n + k)
+    template<typename F>
+    void range(const K &lo, const K &hi, F visit) const {
+        const iterator last = end();
+        for (iterator it = lowerBound(lo); it != last && !(hi < *it); ++it)
+            visit(it.key(), it.value());
     }
 
-    /***************************************************************************
-     *  Red-black tree deletion.
-     ***************************************************************************/
-    // remove the key-value pair with the minimum key rooted at h
-    Node *removeMin(Node *h) {
-        if (h->left == nullptr) {
-            delete h;
-            return nullptr;
+    /*
+     用有序的keys[0, len)、vals[0, len)直接建树，O(n)，不用旋转和变色，树里原来的键值都清掉
+     键要严格递增；不是的话退化成逐个add
+     */
+    void bulkLoad(const K *keys, const V *vals, const int len) {
+        destroy();
+        if (!isIncreasing(keys, len)) {
+            for (int i = 0; i < len; i++)
+                add(keys[i], vals[i]);
+            return;
         }
+        //取能取的最大的黑高h：2^h-1 <= len，这样的2-3树最多放3^h-1个键
+        long long capacity = 0;
+        for (long long full = 1; full <= len; full = full * 2 + 1)
+            capacity = capacity * 3 + 2;
+        root = build(keys, vals, 0, len, capacity);
+    }
+
+    //有序的keys/vals和树里已有的键值归并之后重建，键相同时用新的值，O(n + size())
+    void bulkMerge(const K *keys, const V *vals, const int len) {
+        if (!isIncreasing(keys, len)) {
+            for (int i = 0; i < len; i++)
+                add(keys[i], vals[i]);
+            return;
+        }
+        std::vector<K> mergedKeys;
+        std::vector<V> mergedVals;
+        mergedKeys.reserve(size() + len);
+        mergedVals.reserve(size() + len);
+        std::vector<Node *> stack;
+        Node *x = root;
+        int i = 0;
+        while (x != nullptr || !stack.empty()) {
+            for (; x != nullptr; x = x->left)
+                stack.push_back(x);
+            x = stack.back();
+            stack.pop_back();
+            for (; i < len && keys[i] < x->key; i++) {
+                mergedKeys.push_back(keys[i]);
+                mergedVals.push_back(vals[i]);
+            }
+            mergedKeys.push_back(x->key);
+            if (i < len && !(x->key < keys[i]))
+                mergedVals.push_back(vals[i++]);
+            else
+                mergedVals.push_back(x->val);
+            x = x->right;
+        }
+        for (; i < len; i++) {
+            mergedKeys.push_back(keys[i]);
+            mergedVals.push_back(vals[i]);
+        }
+        bulkLoad(mergedKeys.data(), mergedVals.data(), (int) mergedKeys.size());
+    }
 
-        if (!isRed(h->left) && !isRed(h->left->left))
-            h = moveRedLeft(h);
-
-        h->left = removeMin(h->left);
-        return balance(h);
+    void destroy() {
+        //节点不需要析构时分配器整块释放，不用遍历
+        if (!nodes.canReleaseAll())
+            destroy(root);
+        nodes.releaseAll();
+        root = nullptr;
     }
 
-    // remove the key-value pair with the maximum key rooted at h
-    Node *removeMax(Node *h) {
-        if (isRed(h->left))
-            h = rotateRight(h);
+private:
+    static bool isIncreasing(const K *keys, const int len) {
+        for (int i = 1; i < len; i++)
+            if (!(keys[i - 1] < keys[i]))
+                return false;
+        return true;
+    }
 
-        if (h->right == nullptr) {
-            delete h;
+    /*
+     用keys[lo, lo+n)建一棵黑高为h、红节点都是左孩子的红黑树，也就是一棵高h的2-3树，capacity = 3^h-1，
+     要求2^h-1 <= n <= capacity：
+     n-1个键平分给两棵黑高h-1的子树放得下时根是2-节点；放不下时根是3-节点(黑色的根加红色的左孩子)，
+     n-2个键平分给三棵子树。h取得尽量大，3-节点就都在最下面几层
+     */
+    Node *build(const K *keys, const V *vals, const int lo, const int n, const long long capacity) {
+        if (n == 0)
             return nullptr;
+        const long long childMax = (capacity - 2) / 3;
+        if (n - 1 <= 2 * childMax) {
+            int left = (n - 1) / 2;
+            Node *x = nodes.create(keys[lo + left], vals[lo + left], BLACK, n);
+            x->left = build(keys, vals, lo, left, childMax);
+            x->right = build(keys, vals, lo + left + 1, n - 1 - left, childMax);
+            return adopt(x);
         }
-
-        if (!isRed(h->right) && !isRed(h->right->left))
-            h = moveRedRight(h);
-
-        h->right = removeMax(h->right);
-        return balance(h);
+        int a = (n - 2) / 3;
+        int b = (n - 2 - a) / 2;
+        int c = n - 2 - a - b;
+        Node *y = nodes.create(keys[lo + a], vals[lo + a], RED, a + b + 1);
+        y->left = build(keys, vals, lo, a, childMax);
+        y->right = build(keys, vals, lo + a + 1, b, childMax);
+        adopt(y);
+        Node *x = nodes.create(keys[lo + a + 1 + b], vals[lo + a + 1 + b], BLACK, n);
+        x->left = y;
+        x->right = build(keys, vals, lo + a + b + 2, c, childMax);
+        return adopt(x);
     }
 
-    // remove the key-value pair with the given key rooted at h
-    Node *remove(Node *h, const K &key) {
-        if (key < h->key) {
-            if (!isRed(h->left) && !isRed(h->left->left))
-                h = moveRedLeft(h);
-            h->left = remove(h->left, key);
+    /***************************************************************************
+     *  Red-black tree insertion and deletion (bottom-up).
+     ***************************************************************************/
+    // z是刚插入的红节点，父节点也是红的时往上修复
+    void addFixup(Node *z) {
+        while (isRed(z->parent)) {
+            Node *p = z->parent;
+            Node *g = p->parent;    //p是红的，不是根，一定有父节点
+            if (p == g->left) {
+                Node *uncle = g->right;
+                if (isRed(uncle)) {
+                    //叔叔也是红的：变色，问题上移到祖父
+                    p->color = BLACK;
+                    uncle->color = BLACK;
+                    g->color = RED;
+                    TREE_COUNT_WRITE(colors, 3);
+                    z = g;
+                    continue;
+                }
+                if (z == p->right) {
+                    rotateLeft(p);
+                    z = p;
+                    p = z->parent;
+                }
+                p->color = BLACK;
+                g->color = RED;
+                TREE_COUNT_WRITE(colors, 2);
+                rotateRight(g);
+            } else {
+                Node *uncle = g->left;
+                if (isRed(uncle)) {
+                    p->color = BLACK;
+                    uncle->color = BLACK;
+                    g->color = RED;
+                    TREE_COUNT_WRITE(colors, 3);
+                    z = g;
+                    continue;
+                }
+                if (z == p->left) {
+                    rotateRight(p);
+                    z = p;
+                    p = z->parent;
+                }
+                p->color = BLACK;
+                g->color = RED;
+                TREE_COUNT_WRITE(colors, 2);
+                rotateLeft(g);
+            }
+        }
+        root->color = BLACK;
+        TREE_COUNT_WRITE(colors, 1);
+    }
+
+    // 删掉节点z
+    void removeNode(Node *z) {
+        Node *y = z;                //从树里真正摘掉(或者挪走)的节点
+        bool removedColor = y->color;
+        Node *x;                    //顶替y位置的节点，可能为空
+        Node *xParent;
+        if (z->left == nullptr) {
+            x = z->right;
+            xParent = z->parent;
+            transplant(z, z->right);
+        } else if (z->right == nullptr) {
+            x = z->left;
+            xParent = z->parent;
+            transplant(z, z->left);
         } else {
-            if (isRed(h->left))
-                h = rotateRight(h);
-            if (key == h->key && (h->right == nullptr)) {
-                delete h;
-                return nullptr;
+            //两个孩子：用后继y顶替z，y原来的位置由y的右孩子顶替
+            y = min(z->right);
+            removedColor = y->color;
+            x = y->right;
+            if (y->parent == z) {
+                xParent = y;
+            } else {
+                xParent = y->parent;
+                transplant(y, y->right);
+                y->right = z->right;
+                y->right->parent = y;
+                TREE_COUNT_WRITE(links, 2);
             }
-            if (!isRed(h->right) && !isRed(h->right->left))
-                h = moveRedRight(h);
-            if (key == h->key) {
-                Node *x = min(h->right);
-                h->key = x->key;
-                h->val = x->val;
-                // h->val = get(h->right, min(h->right)->key);
-                // h->key = min(h->right)->key;
-                h->right = removeMin(h->right);
-            } else h->right = remove(h->right, key);
+            transplant(z, y);
+            y->left = z->left;
+            y->left->parent = y;
+            y->color = z->color;
+            TREE_COUNT_WRITE(links, 2);
+            TREE_COUNT_WRITE(colors, 1);
+        }
+        nodes.destroy(z);
+        //xParent往上的子树都少了一个节点，y顶替z以后也在这条路径上
+        for (Node *p = xParent; p != nullptr; p = p->parent) {
+            p->size = size(p->left) + size(p->right) + 1;
+            TREE_COUNT_WRITE(sizes, 1);
+        }
+        if (removedColor == BLACK)
+            removeFixup(x, xParent);
+    }
+
+    // x所在的一侧少了一个黑节点，往上修复
+    void removeFixup(Node *x, Node *parent) {
+        while (x != root && !isRed(x)) {
+            if (x == parent->left) {
+                Node *w = parent->right;    //x这边少一个黑节点，兄弟w一定存在
+                if (isRed(w)) {
+                    w->color = BLACK;
+                    parent->color = RED;
+                    TREE_COUNT_WRITE(colors, 2);
+                    rotateLeft(parent);
+                    w = parent->right;
+                }
+                if (!isRed(w->left) && !isRed(w->right)) {
+                    //兄弟变红，两边一样少一个黑节点，问题上移到父节点
+                    w->color = RED;
+                    TREE_COUNT_WRITE(colors, 1);
+                    x = parent;
+                    parent = x->parent;
+                    continue;
+                }
+                if (!isRed(w->right)) {
+                    w->left->color = BLACK;
+                    w->color = RED;
+                    TREE_COUNT_WRITE(colors, 2);
+                    rotateRight(w);
+                    w = parent->right;
+                }
+                w->color = parent->color;
+                parent->color = BLACK;
+                w->right->color = BLACK;
+                TREE_COUNT_WRITE(colors, 3);
+                rotateLeft(parent);
+                x = root;
+            } else {
+                Node *w = parent->left;
+                if (isRed(w)) {
+                    w->color = BLACK;
+                    parent->color = RED;
+                    TREE_COUNT_WRITE(colors, 2);
+                    rotateRight(parent);
+                    w = parent->left;
+                }
+                if (!isRed(w->left) && !isRed(w->right)) {
+                    w->color = RED;
+                    TREE_COUNT_WRITE(colors, 1);
+                    x = parent;
+                    parent = x->parent;
+                    continue;
+                }
+                if (!isRed(w->left)) {
+                    w->right->color = BLACK;
+                    w->color = RED;
+                    TREE_COUNT_WRITE(colors, 2);
+                    rotateLeft(w);
+                    w = parent->left;
+                }
+                w->color = parent->color;
+                parent->color = BLACK;
+                w->left->color = BLACK;
+                TREE_COUNT_WRITE(colors, 3);
+                rotateRight(parent);
+                x = root;
+            }
+        }
+        if (x != nullptr) {
+            x->color = BLACK;
+            TREE_COUNT_WRITE(colors, 1);
+        }
+    }
+
+    // 用v(可能为空)替换u在父节点里的位置
+    void transplant(Node *u, Node *v) {
+        if (u->parent == nullptr) root = v;
+        else if (u == u->parent->left) u->parent->left = v;
+        else u->parent->right = v;
+        TREE_COUNT_WRITE(links, 1);
+        if (v != nullptr) {
+            v->parent = u->parent;
+            TREE_COUNT_WRITE(links, 1);
         }
-        return balance(h);
     }
 
     /***************************************************************************
      *  Red-black tree helper functions.
      ***************************************************************************/
-    // make a left-leaning link lean to the right
     //     node                   x
     //    /   \     右旋转       /  \
-    //   x    T2   ------->   y   node
+    //   x    T2   ------->   T0   node
     //  / \                       /  \
-    // y  T1                     T1  T2
-
-    Node *rotateRight(Node *node) {
-//        assert((h != nullptr) && isRed(h->left));
-//        assert (h != nullptr) && isRed(h->left) &&  !isRed(h->right);  // for insertion only
+    // T0  T1                    T1  T2
+    void rotateRight(Node *node) {
         Node *x = node->left;
         node->left = x->right;
+        if (x->right != nullptr) x->right->parent = node;
+        TREE_COUNT_WRITE(links, x->right != nullptr ? 2 : 1);
+        transplant(node, x);
         x->right = node;
-        x->color = x->right->color;
-        x->right->color = RED;
+        node->parent = x;
+        TREE_COUNT_WRITE(links, 2);
 
         x->size = node->size;
         node->size = size(node->left) + size(node->right) + 1;
-        return x;
+        TREE_COUNT_WRITE(sizes, 2);
     }
 
-    // make a right-leaning link lean to the left
     //   node                     x
     //  /   \     左旋转         /  \
-    // T1    x   --------->   node   T3
+    // T0    x   --------->   node   T2
     //      / \              /   \
-    //     T2 T3            T1   T2
-
-    Node *rotateLeft(Node *node) {
-//        assert((h != nullptr) && isRed(h->right));
-//        assert ((h != nullptr) && isRed(h->right) && !isRed(h->left));  // for insertion only
+    //     T1 T2            T0   T1
+    void rotateLeft(Node *node) {
         Node *x = node->right;
         node->right = x->left;
+        if (x->left != nullptr) x->left->parent = node;
+        TREE_COUNT_WRITE(links, x->left != nullptr ? 2 : 1);
+        transplant(node, x);
         x->left = node;
-        x->color = x->left->color;
-        x->left->color = RED;
+        node->parent = x;
+        TREE_COUNT_WRITE(links, 2);
 
         x->size = node->size;
         node->size = size(node->left) + size(node->right) + 1;
-        return x;
-    }
-
-    // flip the colors of a Node* and its two children
-    void flipColors(Node *h) {
-        // h must have opposite color of its two children
-        // assert ((h != nullptr) && (h->left != nullptr) && (h->right != nullptr));
-        // assert ((!isRed(h) &&  isRed(h->left) &&  isRed(h->right))
-        //    || (isRed(h)  && !isRed(h->left) && !isRed(h->right)));
-        h->color = !h->color;
-        h->left->color = !h->left->color;
-        h->right->color = !h->right->color;
-    }
-
-    // Assuming that h is red and both h->left and h->left->left
-    // are black, make h->left or one of its children red.
-    Node *moveRedLeft(Node *h) {
-        // assert (h != nullptr);
-        // assert (isRed(h) && !isRed(h->left) && !isRed(h->left->left));
-
-        flipColors(h);
-        if (isRed(h->right->left)) {
-            h->right = rotateRight(h->right);
-            h = rotateLeft(h);
-            flipColors(h);
-        }
-        return h;
-    }
-
-    // Assuming that h is red and both h->right and h->right->left
-    // are black, make h->right or one of its children red.
-    Node *moveRedRight(Node *h) {
-        // assert (h != nullptr);
-        // assert (isRed(h) && !isRed(h->right) && !isRed(h->right->left));
-        flipColors(h);
-        if (isRed(h->left->left)) {
-            h = rotateRight(h);
-            flipColors(h);
-        }
-        return h;
+        TREE_COUNT_WRITE(sizes, 2);
     }
 
-    // restore red-black tree invariant
-    Node *balance(Node *h) {
-        // assert (h != nullptr);
-        if (isRed(h->right) && !isRed(h->left)) h = rotateLeft(h);
-        if (isRed(h->left) && isRed(h->left->left)) h = rotateRight(h);
-        if (isRed(h->left) && isRed(h->right)) flipColors(h);
-
-        h->size = size(h->left) + size(h->right) + 1;
-        return h;
+    // 给x的孩子设上父指针
+    static Node *adopt(Node *x) {
+        if (x->left != nullptr) x->left->parent = x;
+        if (x->right != nullptr) x->right->parent = x;
+        return x;
     }
 
     // is Node* x red; false if x is nullptr ?
@@ -483,7 +686,7 @@ private:
             return;
         destroy(node->left);
         destroy(node->right);
-        delete node;
+        nodes.destroy(node);
     }
 
     int max(const int &a, const int &b) {
@@ -497,15 +700,17 @@ public:
         bool bst = isBST();
         bool sizeConsistent = isSizeConsistent();
         bool RankConsistent = isRankConsistent();
-        bool rbNode = is23();
+        bool rbNode = isRedBlack();
         bool balanced = isBalanced();
+        bool linked = isParentConsistent();
 
         if (!bst) printf("Not in symmetric order\n");
         if (!sizeConsistent) printf("Subtree counts not consistent\n");
         if (!RankConsistent) printf("Ranks not consistent\n");
-        if (!rbNode) printf("Not a 2-3 tree\n");
+        if (!rbNode) printf("Red node has a red child\n");
         if (!balanced) printf("Not balanced\n");
-        return bst && sizeConsistent && RankConsistent && rbNode && balanced;
+        if (!linked) printf("Parent links not consistent\n");
+        return bst && sizeConsistent && RankConsistent && rbNode && balanced && linked;
     }
 
 private:
@@ -542,18 +747,28 @@ private:
         return true;
     }
 
-    // Does the tree have no red right links, and at most one (left)
-    // red links in a row on any path?
-    bool is23() const {
-        return is23(root);
+    // Is the root black, and does no red node have a red child?
+    bool isRedBlack() const {
+        return !isRed(root) && isRedBlack(root);
     }
 
-    bool is23(Node *x) const {
+    bool isRedBlack(Node *x) const {
         if (x == nullptr) return true;
-        if (isRed(x->right)) return false;
-        if (x != root && isRed(x) && isRed(x->left))
+        if (isRed(x) && (isRed(x->left) || isRed(x->right)))
             return false;
-        return is23(x->left) && is23(x->right);
+        return isRedBlack(x->left) && isRedBlack(x->right);
+    }
+
+    // does every child point back to its parent?
+    bool isParentConsistent() const {
+        return (root == nullptr || root->parent == nullptr) && isParentConsistent(root);
+    }
+
+    bool isParentConsistent(Node *x) const {
+        if (x == nullptr) return true;
+        if (x->left != nullptr && x->left->parent != x) return false;
+        if (x->right != nullptr && x->right->parent != x) return false;
+        return isParentConsistent(x->left) && isParentConsistent(x->right);
     }
 
     // do all paths from root to leaf have same number of black edges?
@@ -575,4 +790,11 @@ private:
     }
 };
 
+//颜色通过引用转发给Allocator::create，要有定义
+template<typename K, typename V, template<typename> class Allocator>
+const bool RBTree<K, V, Allocator>::RED;
+
+template<typename K, typename V, template<typename> class Allocator>
+const bool RBTree<K, V, Allocator>::BLACK;
+
 #endif
\ No newline at end of file
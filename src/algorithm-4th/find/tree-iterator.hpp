@@ -0,0 +1,173 @@
+#ifndef _TREE_ITERATOR_H_
+#define _TREE_ITERATOR_H_
+
+#include <cstddef>
+#include <iterator>
+
+/*
+ 二叉查找树(BSTree、AVLTree、RBTree)的双向只读迭代器，参考C++STL/02-tree-iter.cpp里的tree_iterator：
+   - 不用父指针，也不分配内存(tree_iterator用的是std::stack)：迭代器里放一个定长的数组，
+     存从根到当前节点的路径，++/--沿着路径上下走，均摊O(1)，从lowerBound开始扫描k个键是O(log n + k)；
+   - 平衡树的高度远小于MAX_DEPTH；退化的BST比MAX_DEPTH深时路径存不下，
+     这时每一步从根往下重新找后继/前驱，O(h)，结果一样；
+   - 树修改以后原来的迭代器失效。
+ Node要有key、val、left、right成员，*it是键，it.value()是值。
+ */
+template<typename Node, typename K, typename V>
+class TreeIterator {
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef K value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const K *pointer;
+    typedef const K &reference;
+
+    TreeIterator() : root(nullptr), node(nullptr), depth(0) {}
+
+    //指向树的末尾(end)
+    explicit TreeIterator(const Node *root) : root(root), node(nullptr), depth(0) {}
+
+    static TreeIterator first(const Node *root) {
+        TreeIterator it(root);
+        for (const Node *x = root; x != nullptr; x = x->left)
+            it.push(x);
+        return it;
+    }
+
+    static TreeIterator last(const Node *root) {
+        TreeIterator it(root);
+        for (const Node *x = root; x != nullptr; x = x->right)
+            it.push(x);
+        return it;
+    }
+
+    //第一个大于等于key的节点，没有时是end
+    static TreeIterator lowerBound(const Node *root, const K &key) {
+        TreeIterator it(root);
+        it.seekAfter(key, false);
+        return it;
+    }
+
+    //第一个大于key的节点，没有时是end
+    static TreeIterator upperBound(const Node *root, const K &key) {
+        TreeIterator it(root);
+        it.seekAfter(key, true);
+        return it;
+    }
+
+    reference operator*() const { return node->key; }
+
+    pointer operator->() const { return &node->key; }
+
+    const K &key() const { return node->key; }
+
+    const V &value() const { return node->val; }
+
+    bool operator==(const TreeIterator &that) const { return node == that.node; }
+
+    bool operator!=(const TreeIterator &that) const { return node != that.node; }
+
+    TreeIterator &operator++() {
+        if (depth > MAX_DEPTH) {
+            seekAfter(node->key, true);
+        } else if (node->right != nullptr) {
+            //右子树里最小的
+            for (const Node *x = node->right; x != nullptr; x = x->left)
+                push(x);
+        } else {
+            //往上走到第一个从左孩子上来的祖先
+            while (depth > 1 && path[depth - 2]->right == path[depth - 1])
+                depth--;
+            depth--;
+            node = depth > 0 ? path[depth - 1] : nullptr;
+        }
+        return *this;
+    }
+
+    TreeIterator &operator--() {
+        if (node == nullptr) {
+            *this = last(root);
+        } else if (depth > MAX_DEPTH) {
+            seekBefore(node->key);
+        } else if (node->left != nullptr) {
+            for (const Node *x = node->left; x != nullptr; x = x->right)
+                push(x);
+        } else {
+            while (depth > 1 && path[depth - 2]->left == path[depth - 1])
+                depth--;
+            depth--;
+            node = depth > 0 ? path[depth - 1] : nullptr;
+        }
+        return *this;
+    }
+
+    TreeIterator operator++(int) {
+        TreeIterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    TreeIterator operator--(int) {
+        TreeIterator old = *this;
+        --*this;
+        return old;
+    }
+
+private:
+    //n个节点的AVL树高度不超过1.44log2(n)，左倾红黑树不超过2log2(n)，int放得下的n都不到64层
+    static const int MAX_DEPTH = 64;
+
+    const Node *root;
+    const Node *node;   //当前节点，end时为空
+    int depth;          //node在第几层(根是1)，不超过MAX_DEPTH时path[0, depth)是从根到node的路径
+    const Node *path[MAX_DEPTH];
+
+    void push(const Node *x) {
+        if (depth < MAX_DEPTH)
+            path[depth] = x;
+        depth++;
+        node = x;
+    }
+
+    //从根往下找第一个大于(strict)或大于等于key的节点，路径重新记录
+    void seekAfter(const K &key, const bool strict) {
+        depth = 0;
+        node = nullptr;
+        const Node *best = nullptr;
+        int bestDepth = 0;
+        for (const Node *x = root; x != nullptr;) {
+            push(x);
+            if (strict ? key < x->key : !(x->key < key)) {
+                best = x;
+                bestDepth = depth;
+                x = x->left;
+            } else {
+                x = x->right;
+            }
+        }
+        node = best;
+        depth = bestDepth;
+    }
+
+    //从根往下找最后一个小于key的节点
+    void seekBefore(const K &key) {
+        depth = 0;
+        node = nullptr;
+        const Node *best = nullptr;
+        int bestDepth = 0;
+        for (const Node *x = root; x != nullptr;) {
+            push(x);
+            if (x->key < key) {
+                best = x;
+                bestDepth = depth;
+                x = x->right;
+            } else {
+                x = x->left;
+            }
+        }
+        node = best;
+        depth = bestDepth;
+    }
+};
+
+#endif
@@ -1,8 +1,17 @@
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 #include <ctime>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
 #include "rbtree.hpp"
+#include "llrbtree.hpp"
 #include "avl.hpp"
 #include "bst.hpp"
+#include "bplustree.hpp"
+#include "../sort/PerfCounters.hpp"
 #include <thread>
 
 #ifndef NDEBUG
@@ -211,34 +220,266 @@ clock_t testPerformance(TREE &tree, const int len, const int step = 4) {
 }
 
 
+//--perf: 同时统计硬件性能计数器
+static bool perfEnabled = false;
+
+static void printCounters(const PerfSample &perf) {
+    printf("    cycles %lld, instructions %lld, ipc %.2f, branch-misses %lld, l1d-misses %lld, llc-misses %lld\n",
+           perf[PERF_CYCLES], perf[PERF_INSTRUCTIONS], perf.ipc(), perf[PERF_BRANCH_MISSES],
+           perf[PERF_L1D_MISSES], perf[PERF_LLC_MISSES]);
+}
+
 template<typename TREE>
 void testPerformanceTime(const char *name, TREE &tree, const int len, int step = 4) {
+    //只统计调用的线程
+    PerfCounters counters(false);
+    bool counting = perfEnabled && counters.start();
     auto t = testPerformance(tree, len, step);
     printf("%s spent %ld\n", name, t);
+    if (counting)
+        printCounters(counters.stop());
+}
+
+/*
+ 分配器的对比：按随机顺序插入所有键，删掉一半再插回去(ArenaAllocator会复用删掉的节点)，
+ 全部查找一遍，最后销毁整棵树
+ */
+template<typename TREE>
+void testAllocator(const char *name, const std::vector<int> &keys) {
+    TREE tree;
+    PerfCounters counters(false);
+    bool counting = perfEnabled && counters.start();
+    auto s = std::chrono::steady_clock::now();
+    for (int key : keys)
+        tree.add(key, key);
+    for (size_t i = 0; i < keys.size(); i += 2)
+        tree.remove(keys[i]);
+    for (size_t i = 0; i < keys.size(); i += 2)
+        tree.add(keys[i], keys[i]);
+    int found = 0;
+    for (int key : keys)
+        found += tree.get(key) != nullptr;
+    tree.destroy();
+    auto e = std::chrono::steady_clock::now();
+    ASSERT(found == (int) keys.size(), "lost keys");
+    printf("%s spent %.1f ms\n", name, std::chrono::duration<double, std::milli>(e - s).count());
+    if (counting)
+        printCounters(counters.stop());
+}
+
+/*
+ 批量建树：有序的偶数键bulkLoad，再把有序的奇数键bulkMerge进去，和逐个add比较
+ BST按顺序add会退化成链表，bulkLoad建出来的是平衡的
+ */
+template<typename TREE>
+void testBulkLoad(const char *name, const int len) {
+    std::vector<int> evens, odds;
+    for (int i = 0; i < len; i++)
+        (i % 2 == 0 ? evens : odds).push_back(i);
+    TREE tree;
+    auto s = std::chrono::steady_clock::now();
+    tree.bulkLoad(evens.data(), evens.data(), (int) evens.size());
+    auto m = std::chrono::steady_clock::now();
+    tree.bulkMerge(odds.data(), odds.data(), (int) odds.size());
+    auto e = std::chrono::steady_clock::now();
+    int found = 0;
+    for (int i = 0; i < len; i++)
+        found += tree.get(i) != nullptr && *tree.get(i) == i;
+    ASSERT(tree.size() == len && found == len, "bulk load lost keys");
+    printf("%s bulkLoad %.1f ms, bulkMerge %.1f ms, height %d\n", name,
+           std::chrono::duration<double, std::milli>(m - s).count(),
+           std::chrono::duration<double, std::milli>(e - m).count(), tree.height());
+}
+
+/*
+ 范围查询：随机取queries个lo，求[lo, lo+width)里键的和；range用迭代器，O(log n + k)
+ withSelect时再用rank+select做一遍对比，O(k log n)(BSTree和AVLTree的select要现算子树大小，太慢，不比)
+ */
+template<typename TREE>
+void testRange(const char *name, const int len, const int width, const bool withSelect) {
+    const int queries = 1000;
+    std::vector<int> keys(len);
+    for (int i = 0; i < len; i++)
+        keys[i] = i;
+    TREE tree;
+    tree.bulkLoad(keys.data(), keys.data(), len);
+    std::mt19937 rng(20210223);
+    long long sum = 0;
+    auto s = std::chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        int lo = (int) (rng() % len);
+        tree.range(lo, lo + width - 1, [&sum](const int &key, const int &) { sum += key; });
+    }
+    auto e = std::chrono::steady_clock::now();
+    printf("%s range %.1f ms", name, std::chrono::duration<double, std::milli>(e - s).count());
+    if (withSelect) {
+        rng.seed(20210223);
+        long long expect = 0;
+        s = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; q++) {
+            int lo = (int) (rng() % len);
+            for (int r = tree.rank(lo); r < tree.size(); r++) {
+                const int *key = tree.select(r);
+                if (*key > lo + width - 1)
+                    break;
+                expect += *key;
+            }
+        }
+        e = std::chrono::steady_clock::now();
+        ASSERT(sum == expect, "range is error");
+        printf(", rank/select %.1f ms", std::chrono::duration<double, std::milli>(e - s).count());
+    }
+    printf("\n");
+}
+
+/*
+ 修改的吞吐量：先按随机顺序插入一半的键，再随机地交替插入、删除ops次，只统计后面这段
+ RBTree和AVLTree自底向上地修复，树的结构不变时不会往上写；LLRBTree递归地重写整条路径，作对比
+ */
+template<typename TREE>
+void testMutation(const char *name, const std::vector<int> &keys, const int ops) {
+    TREE tree;
+    for (size_t i = 0; i < keys.size() / 2; i++)
+        tree.add(keys[i], keys[i]);
+    std::mt19937 rng(20210223);
+    PerfCounters counters(false);
+    bool counting = perfEnabled && counters.start();
+    auto s = std::chrono::steady_clock::now();
+    for (int i = 0; i < ops; i++) {
+        int key = keys[rng() % keys.size()];
+        if (i & 1)
+            tree.remove(key);
+        else
+            tree.add(key, key);
+    }
+    auto e = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(e - s).count();
+    printf("%s %d mutations spent %.1f ms, %.2f Mops/s\n", name, ops, ms, ops / ms / 1000);
+    if (counting)
+        printCounters(counters.stop());
 }
 
-int main() {
+#ifdef TREE_COUNT_WRITES
+//和testMutation一样的add/remove序列，统计平均每次操作写节点的次数(链接、颜色、子树大小、高度)
+template<typename TREE>
+void testWrites(const char *name, const std::vector<int> &keys, const int ops) {
+    TREE tree;
+    for (size_t i = 0; i < keys.size() / 2; i++)
+        tree.add(keys[i], keys[i]);
+    tree.resetWriteCount();
+    std::mt19937 rng(20210223);
+    for (int i = 0; i < ops; i++) {
+        int key = keys[rng() % keys.size()];
+        if (i & 1)
+            tree.remove(key);
+        else
+            tree.add(key, key);
+    }
+    const TreeWriteCount &w = tree.writeCount();
+    printf("%s writes per mutation: links %.2f, colors %.2f, sizes %.2f, heights %.2f, total %.2f\n", name,
+           (double) w.links / ops, (double) w.colors / ops, (double) w.sizes / ops, (double) w.heights / ops,
+           (double) w.total() / ops);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--perf") == 0) {
+            perfEnabled = true;
+        } else {
+            printf("usage: %s [--perf]\n", argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (perfEnabled && !PerfCounters::supported())
+        printf("perf_event_open is not available, counters are disabled\n");
+
     BSTree<int, int> bst;
     AVLTree<int, int> avl;
     RBTree<int, int> rbt;
+    LLRBTree<int, int> llrb;
+    AVLTree<int, int, ArenaAllocator> avlArena;
+    RBTree<int, int, ArenaAllocator> rbtArena;
+    BPlusTree<int, int> bpt;
+    BPlusTree<int, int, ArenaAllocator> bptArena;
     int len = 2000;
 
     std::thread btt([&]() { testFunction("bst", bst, len); });
     std::thread att([&]() { testFunction("avl", avl, len); });
     std::thread rtt([&]() { testFunction("rbt", rbt, len); });
+    std::thread ltt([&]() { testFunction("llrb", llrb, len); });
+    std::thread aatt([&]() { testFunction("avl-arena", avlArena, len); });
+    std::thread ratt([&]() { testFunction("rbt-arena", rbtArena, len); });
+    std::thread ptt([&]() { testFunction("bpt", bpt, len); });
+    std::thread patt([&]() { testFunction("bpt-arena", bptArena, len); });
 
     btt.join();
     att.join();
     rtt.join();
+    ltt.join();
+    aatt.join();
+    ratt.join();
+    ptt.join();
+    patt.join();
 
     len = 200000;
     int step = 4;
-    std::thread bt([&]() { testPerformanceTime("avl", avl, len, step); });
-    std::thread at([&]() { testPerformanceTime("rbt", rbt, len, step); });
-    std::thread rt([&]() { testPerformanceTime("bst", bst, len, step); });
+    if (perfEnabled) {
+        //几棵树同时跑会互相挤占缓存，统计计数器时一棵一棵地跑
+        testPerformanceTime("avl", avl, len, step);
+        testPerformanceTime("rbt", rbt, len, step);
+        testPerformanceTime("llrb", llrb, len, step);
+        testPerformanceTime("bst", bst, len, step);
+        testPerformanceTime("bpt", bpt, len, step);
+    } else {
+        std::thread bt([&]() { testPerformanceTime("avl", avl, len, step); });
+        std::thread at([&]() { testPerformanceTime("rbt", rbt, len, step); });
+        std::thread lt([&]() { testPerformanceTime("llrb", llrb, len, step); });
+        std::thread rt([&]() { testPerformanceTime("bst", bst, len, step); });
+        std::thread pt([&]() { testPerformanceTime("bpt", bpt, len, step); });
+
+        bt.join();
+        at.join();
+        lt.join();
+        rt.join();
+        pt.join();
+    }
+
+    //随机顺序的键，BST也不会退化；依次跑，免得互相影响
+    std::vector<int> keys(1000000);
+    for (int i = 0; i < (int) keys.size(); i++)
+        keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(20210223));
+    testAllocator<BSTree<int, int> >("bst heap", keys);
+    testAllocator<BSTree<int, int, ArenaAllocator> >("bst arena", keys);
+    testAllocator<AVLTree<int, int> >("avl heap", keys);
+    testAllocator<AVLTree<int, int, ArenaAllocator> >("avl arena", keys);
+    testAllocator<RBTree<int, int> >("rbt heap", keys);
+    testAllocator<RBTree<int, int, ArenaAllocator> >("rbt arena", keys);
+    testAllocator<BPlusTree<int, int> >("bpt heap", keys);
+    testAllocator<BPlusTree<int, int, ArenaAllocator> >("bpt arena", keys);
+
+    testMutation<BSTree<int, int> >("bst", keys, 2000000);
+    testMutation<AVLTree<int, int> >("avl", keys, 2000000);
+    testMutation<LLRBTree<int, int> >("llrb", keys, 2000000);
+    testMutation<RBTree<int, int> >("rbt", keys, 2000000);
+    testMutation<BPlusTree<int, int> >("bpt", keys, 2000000);
+#ifdef TREE_COUNT_WRITES
+    testWrites<AVLTree<int, int> >("avl", keys, 2000000);
+    testWrites<LLRBTree<int, int> >("llrb", keys, 2000000);
+    testWrites<RBTree<int, int> >("rbt", keys, 2000000);
+#else
+    printf("build with -DTREE_COUNT_WRITES to count node writes per mutation\n");
+#endif
+
+    testBulkLoad<BSTree<int, int> >("bst", 1000000);
+    testBulkLoad<AVLTree<int, int> >("avl", 1000000);
+    testBulkLoad<RBTree<int, int> >("rbt", 1000000);
+    testBulkLoad<BPlusTree<int, int> >("bpt", 1000000);
 
-    bt.join();
-    at.join();
-    rt.join();
+    testRange<BSTree<int, int> >("bst", 1000000, 1000, false);
+    testRange<AVLTree<int, int> >("avl", 1000000, 1000, false);
+    testRange<RBTree<int, int> >("rbt", 1000000, 1000, true);
+    testRange<BPlusTree<int, int> >("bpt", 1000000, 1000, true);
     return 0;
 }
\ No newline at end of file
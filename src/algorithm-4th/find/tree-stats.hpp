@@ -0,0 +1,25 @@
+#ifndef _TREE_STATS_H_
+#define _TREE_STATS_H_
+
+/*
+ 写计数：编译时定义了TREE_COUNT_WRITES，RBTree、AVLTree、LLRBTree在add/remove里每写一次节点的
+ 链接(left/right/parent和root)、颜色、子树大小或者高度就记一次数，不管写进去的值和原来是不是一样。
+ 递归的实现回溯时把路径上的指针和大小都重新赋值一遍，自底向上的实现只写真正变了的地方，用它来对比。
+ 没有定义时计数的语句都是空的，树里只多一个用不到的成员，不影响计时。
+ */
+struct TreeWriteCount {
+    long long links = 0;
+    long long colors = 0;
+    long long sizes = 0;
+    long long heights = 0;
+
+    long long total() const { return links + colors + sizes + heights; }
+};
+
+#ifdef TREE_COUNT_WRITES
+#define TREE_COUNT_WRITE(field, n) (writes.field += (n))
+#else
+#define TREE_COUNT_WRITE(field, n) ((void) 0)
+#endif
+
+#endif
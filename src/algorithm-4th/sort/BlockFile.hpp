@@ -0,0 +1,499 @@
+#ifndef BLOCKFILE_HPP
+#define BLOCKFILE_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BlockingQueue.hpp"
+
+/*
+ 外部排序用的二进制文件读写
+ 文件里直接存放T的二进制表示，没有任何分隔符，读写都是按大块(默认1MB)进行的，
+ 缓冲区按页对齐，一次read/write系统调用搬运一整块数据，省去了fscanf/fprintf逐个解析文本的开销。
+ T必须是可以按字节拷贝的类型。
+ */
+
+static const size_t BLOCK_FILE_ALIGN = 4096;
+static const size_t BLOCK_FILE_DEFAULT_BYTES = 1 << 20;
+
+inline void *blockFileAlloc(size_t bytes) {
+    void *p = nullptr;
+    if (posix_memalign(&p, BLOCK_FILE_ALIGN, bytes) != 0) {
+        perror("Error while allocating the io buffer.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+inline int blockFileOpen(const char *fileName, int flags) {
+    int fd = ::open(fileName, flags, 0644);
+    if (fd < 0) {
+        perror("Error while opening the file.\n");
+        exit(EXIT_FAILURE);
+    }
+    return fd;
+}
+
+//写满bytes个字节
+inline void blockFileWrite(int fd, const void *data, size_t bytes) {
+    const char *p = (const char *) data;
+    while (bytes > 0) {
+        ssize_t r = ::write(fd, p, bytes);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("Error while writing the file.\n");
+            exit(EXIT_FAILURE);
+        }
+        p += r;
+        bytes -= (size_t) r;
+    }
+}
+
+//尽量读满bytes个字节，返回实际读到的字节数，小于bytes说明到了文件末尾
+inline size_t blockFileRead(int fd, void *data, size_t bytes) {
+    char *p = (char *) data;
+    size_t got = 0;
+    while (got < bytes) {
+        ssize_t r = ::read(fd, p + got, bytes - got);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("Error while reading the file.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (r == 0)
+            break;
+        got += (size_t) r;
+    }
+    return got;
+}
+
+//顺序写：先写到缓冲区，缓冲区满了一次性写到文件
+template<typename T>
+class BlockWriter {
+public:
+    explicit BlockWriter(size_t blockBytes = BLOCK_FILE_DEFAULT_BYTES)
+            : fd(-1), capacity(blockElements(blockBytes)), count(0), written(0) {
+        buffer = (T *) blockFileAlloc(capacity * sizeof(T));
+    }
+
+    BlockWriter(const char *fileName, size_t blockBytes = BLOCK_FILE_DEFAULT_BYTES) : BlockWriter(blockBytes) {
+        open(fileName);
+    }
+
+    ~BlockWriter() {
+        close();
+        free(buffer);
+    }
+
+    BlockWriter(const BlockWriter &) = delete;
+
+    BlockWriter &operator=(const BlockWriter &) = delete;
+
+    void open(const char *fileName) {
+        close();
+        fd = blockFileOpen(fileName, O_WRONLY | O_CREAT | O_TRUNC);
+        count = 0;
+        written = 0;
+    }
+
+    void write(const T &x) {
+        buffer[count++] = x;
+        if (count == capacity)
+            flush();
+    }
+
+    void write(const T *arr, size_t n) {
+        while (n > 0) {
+            size_t m = capacity - count < n ? capacity - count : n;
+            memcpy(buffer + count, arr, m * sizeof(T));
+            count += m;
+            arr += m;
+            n -= m;
+            if (count == capacity)
+                flush();
+        }
+    }
+
+    void flush() {
+        blockFileWrite(fd, buffer, count * sizeof(T));
+        written += count;
+        count = 0;
+    }
+
+    void close() {
+        if (fd < 0)
+            return;
+        flush();
+        ::close(fd);
+        fd = -1;
+    }
+
+    //已经写出的元素个数
+    size_t size() const { return written + count; }
+
+private:
+    int fd;
+    T *buffer;
+    size_t capacity;
+    size_t count;
+    size_t written;
+
+    static size_t blockElements(size_t blockBytes) {
+        size_t n = blockBytes / sizeof(T);
+        return n > 0 ? n : 1;
+    }
+};
+
+//顺序读：一次读满整个缓冲区，next()可以直接作为败者树的输入
+template<typename T>
+class BlockReader {
+public:
+    explicit BlockReader(size_t blockBytes = BLOCK_FILE_DEFAULT_BYTES)
+            : fd(-1), capacity(blockElements(blockBytes)), pos(0), count(0), eof(true) {
+        buffer = (T *) blockFileAlloc(capacity * sizeof(T));
+    }
+
+    BlockReader(const char *fileName, size_t blockBytes = BLOCK_FILE_DEFAULT_BYTES) : BlockReader(blockBytes) {
+        open(fileName);
+    }
+
+    ~BlockReader() {
+        close();
+        free(buffer);
+    }
+
+    BlockReader(const BlockReader &) = delete;
+
+    BlockReader &operator=(const BlockReader &) = delete;
+
+    void open(const char *fileName) {
+        close();
+        fd = blockFileOpen(fileName, O_RDONLY);
+#ifdef POSIX_FADV_SEQUENTIAL
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        pos = count = 0;
+        eof = false;
+    }
+
+    void close() {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+        eof = true;
+    }
+
+    bool next(T &x) {
+        if (pos == count && !refill())
+            return false;
+        x = buffer[pos++];
+        return true;
+    }
+
+    //最多读n个元素到arr，返回实际读到的个数
+    size_t read(T *arr, size_t n) {
+        size_t total = 0;
+        while (total < n) {
+            if (pos == count && !refill())
+                break;
+            size_t m = count - pos < n - total ? count - pos : n - total;
+            memcpy(arr + total, buffer + pos, m * sizeof(T));
+            pos += m;
+            total += m;
+        }
+        return total;
+    }
+
+private:
+    int fd;
+    T *buffer;
+    size_t capacity;
+    size_t pos;
+    size_t count;
+    bool eof;
+
+    static size_t blockElements(size_t blockBytes) {
+        size_t n = blockBytes / sizeof(T);
+        return n > 0 ? n : 1;
+    }
+
+    bool refill() {
+        if (eof)
+            return false;
+        size_t want = capacity * sizeof(T);
+        size_t got = blockFileRead(fd, buffer, want);
+        if (got < want)
+            eof = true;
+        pos = 0;
+        count = got / sizeof(T);
+        return count > 0;
+    }
+};
+
+//把整个输入文件只读映射到内存，由内核按顺序预读
+template<typename T>
+class MappedFile {
+public:
+    explicit MappedFile(const char *fileName) : addr(nullptr), bytes(0) {
+        int fd = blockFileOpen(fileName, O_RDONLY);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            perror("Error while reading the file size.\n");
+            exit(EXIT_FAILURE);
+        }
+        bytes = (size_t) st.st_size;
+        if (bytes > 0) {
+            addr = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                perror("Error while mapping the file.\n");
+                exit(EXIT_FAILURE);
+            }
+            madvise(addr, bytes, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (addr != nullptr)
+            munmap(addr, bytes);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const T *data() const { return (const T *) addr; }
+
+    size_t size() const { return bytes / sizeof(T); }
+
+private:
+    void *addr;
+    size_t bytes;
+};
+
+/*
+ 后台I/O线程
+ AsyncBlockReader/AsyncBlockWriter把读写整块的系统调用交给这几个线程，调用方在处理当前块的同时，
+ 下一块已经在读(写)了，CPU和磁盘同时工作。
+ */
+class BlockFileIo {
+public:
+    explicit BlockFileIo(unsigned threadNum = 2) : tasks(1024) {
+        for (unsigned i = 0; i < threadNum; i++)
+            workers.push_back(std::thread([this]() {
+                std::function<void()> task;
+                while (tasks.pop(task))
+                    task();
+            }));
+    }
+
+    ~BlockFileIo() {
+        tasks.close();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    static BlockFileIo &instance() {
+        static BlockFileIo io;
+        return io;
+    }
+
+    std::future<size_t> submit(const std::function<size_t()> &job) {
+        std::shared_ptr<std::packaged_task<size_t()>> task(new std::packaged_task<size_t()>(job));
+        std::future<size_t> res = task->get_future();
+        tasks.push([task]() { (*task)(); });
+        return res;
+    }
+
+private:
+    BlockingQueue<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+};
+
+//双缓冲预读：消费一个块的同时，后台线程已经在读下一个块
+template<typename T>
+class AsyncBlockReader {
+public:
+    explicit AsyncBlockReader(size_t blockBytes = BLOCK_FILE_DEFAULT_BYTES)
+            : fd(-1), capacity(blockElements(blockBytes)), cur(0), pos(0), count(0) {
+        buffers[0] = (T *) blockFileAlloc(capacity * sizeof(T));
+        buffers[1] = (T *) blockFileAlloc(capacity * sizeof(T));
+    }
+
+    AsyncBlockReader(const char *fileName, size_t blockBytes = BLOCK_FILE_DEFAULT_BYTES)
+            : AsyncBlockReader(blockBytes) {
+        open(fileName);
+    }
+
+    ~AsyncBlockReader() {
+        close();
+        free(buffers[0]);
+        free(buffers[1]);
+    }
+
+    AsyncBlockReader(const AsyncBlockReader &) = delete;
+
+    AsyncBlockReader &operator=(const AsyncBlockReader &) = delete;
+
+    void open(const char *fileName) {
+        close();
+        fd = blockFileOpen(fileName, O_RDONLY);
+#ifdef POSIX_FADV_SEQUENTIAL
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        pos = count = 0;
+        cur = 1;
+        prefetch(0);
+    }
+
+    void close() {
+        if (pending.valid())
+            pending.wait();
+        pending = std::future<size_t>();
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+
+    bool next(T &x) {
+        if (pos == count && !advance())
+            return false;
+        x = buffers[cur][pos++];
+        return true;
+    }
+
+private:
+    int fd;
+    T *buffers[2];
+    size_t capacity;
+    int cur;    //正在消费的缓冲区
+    size_t pos;
+    size_t count;
+    std::future<size_t> pending;    //正在后台读的那个缓冲区
+
+    static size_t blockElements(size_t blockBytes) {
+        size_t n = blockBytes / sizeof(T);
+        return n > 0 ? n : 1;
+    }
+
+    void prefetch(int b) {
+        int file = fd;
+        T *buffer = buffers[b];
+        size_t bytes = capacity * sizeof(T);
+        pending = BlockFileIo::instance().submit([file, buffer, bytes]() {
+            return blockFileRead(file, buffer, bytes);
+        });
+    }
+
+    //切换到已经读好的缓冲区，并开始预读下一块
+    bool advance() {
+        if (!pending.valid())
+            return false;
+        size_t got = pending.get();
+        cur = 1 - cur;
+        pos = 0;
+        count = got / sizeof(T);
+        if (got == capacity * sizeof(T))
+            prefetch(1 - cur);
+        return count > 0;
+    }
+};
+
+//双缓冲写：一个缓冲区写满后交给后台线程落盘，同时继续往另一个缓冲区里写
+template<typename T>
+class AsyncBlockWriter {
+public:
+    explicit AsyncBlockWriter(size_t blockBytes = BLOCK_FILE_DEFAULT_BYTES)
+            : fd(-1), capacity(blockElements(blockBytes)), cur(0), count(0) {
+        buffers[0] = (T *) blockFileAlloc(capacity * sizeof(T));
+        buffers[1] = (T *) blockFileAlloc(capacity * sizeof(T));
+    }
+
+    AsyncBlockWriter(const char *fileName, size_t blockBytes = BLOCK_FILE_DEFAULT_BYTES)
+            : AsyncBlockWriter(blockBytes) {
+        open(fileName);
+    }
+
+    ~AsyncBlockWriter() {
+        close();
+        free(buffers[0]);
+        free(buffers[1]);
+    }
+
+    AsyncBlockWriter(const AsyncBlockWriter &) = delete;
+
+    AsyncBlockWriter &operator=(const AsyncBlockWriter &) = delete;
+
+    void open(const char *fileName) {
+        close();
+        fd = blockFileOpen(fileName, O_WRONLY | O_CREAT | O_TRUNC);
+        cur = 0;
+        count = 0;
+    }
+
+    void write(const T *arr, size_t n) {
+        while (n > 0) {
+            size_t m = capacity - count < n ? capacity - count : n;
+            memcpy(buffers[cur] + count, arr, m * sizeof(T));
+            count += m;
+            arr += m;
+            n -= m;
+            if (count == capacity)
+                flushAsync();
+        }
+    }
+
+    void close() {
+        if (fd < 0)
+            return;
+        if (pending.valid())
+            pending.wait();
+        blockFileWrite(fd, buffers[cur], count * sizeof(T));
+        count = 0;
+        ::close(fd);
+        fd = -1;
+    }
+
+private:
+    int fd;
+    T *buffers[2];
+    size_t capacity;
+    int cur;
+    size_t count;
+    std::future<size_t> pending;
+
+    static size_t blockElements(size_t blockBytes) {
+        size_t n = blockBytes / sizeof(T);
+        return n > 0 ? n : 1;
+    }
+
+    void flushAsync() {
+        //另一个缓冲区上一次的写必须先完成
+        if (pending.valid())
+            pending.wait();
+        int file = fd;
+        T *buffer = buffers[cur];
+        size_t bytes = count * sizeof(T);
+        pending = BlockFileIo::instance().submit([file, buffer, bytes]() {
+            blockFileWrite(file, buffer, bytes);
+            return bytes;
+        });
+        cur = 1 - cur;
+        count = 0;
+    }
+};
+
+#endif //BLOCKFILE_HPP
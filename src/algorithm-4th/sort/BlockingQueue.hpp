@@ -0,0 +1,58 @@
+#ifndef BLOCKINGQUEUE_HPP
+#define BLOCKINGQUEUE_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+
+/*
+ 有界阻塞队列，用于流水线各个阶段之间传递数据
+ 队列满时push阻塞，队列空时pop阻塞；close()之后push不再接受数据，pop取完剩余数据后返回false。
+ */
+template<typename T>
+class BlockingQueue {
+public:
+    explicit BlockingQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1), closed_(false) {}
+
+    BlockingQueue(const BlockingQueue &) = delete;
+
+    BlockingQueue &operator=(const BlockingQueue &) = delete;
+
+    bool push(T elem) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this]() { return closed_ || queue_.size() < capacity_; });
+        if (closed_)
+            return false;
+        queue_.push(std::move(elem));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    bool pop(T &elem) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this]() { return closed_ || !queue_.empty(); });
+        if (queue_.empty())
+            return false;
+        elem = std::move(queue_.front());
+        queue_.pop();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+private:
+    std::queue<T> queue_;
+    size_t capacity_;
+    bool closed_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+};
+
+#endif //BLOCKINGQUEUE_HPP
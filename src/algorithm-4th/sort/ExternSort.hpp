@@ -1,350 +1,417 @@
-
-
-// C++ program to implement 
-// external sorting using 
-// merge sort 
-#include <iostream>
-
-
-
-using namespace std;
-
+#ifndef EXTERNSORT_HPP
+#define EXTERNSORT_HPP
+
+// External sorting using
+// run generation + K-way merging
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "BlockFile.hpp"
+#include "BlockingQueue.hpp"
+#include "LoserTree.hpp"
+#include "QuickSortMuiltThread.hpp"
+
+template<typename T>
 struct MinHeapNode {
-    // The element to be stored 
-    int element;
+    // The element to be stored
+    T element;
 
-    // index of the array from which 
-    // the element is taken 
+    // index of the run the element
+    // belongs to (replacement selection)
     int i;
 };
 
-// Prototype of a utility function 
-// to swap two min heap nodes 
-void swap(MinHeapNode* x, MinHeapNode* y);
-
-// A class for Min Heap 
+// A class for Min Heap
+// Nodes are ordered by run number first,
+// then by element
+template<typename T, typename Compare = std::less<T> >
 class MinHeap {
-    // pointer to array of elements in heap 
-    MinHeapNode* harr;
+    // pointer to array of elements in heap
+    MinHeapNode<T> *harr;
 
-    // size of min heap 
+    // size of min heap
     int heap_size;
 
+    Compare comp;
+
 public:
-    // Constructor: creates a min 
-    // heap of given size 
-    MinHeap(MinHeapNode a[], int size);
+    // Constructor: Builds a heap from
+    // a given array a[] of given size
+    MinHeap(MinHeapNode<T> a[], int size, Compare comp = Compare()) : harr(a), heap_size(size), comp(comp) {
+        int i = (heap_size - 1) / 2;
+        while (i >= 0) {
+            MinHeapify(i);
+            i--;
+        }
+    }
 
-    // to heapify a subtree with 
-    // root at given index 
-    void MinHeapify(int);
+    // A recursive method to heapify
+    // a subtree with root
+    // at given index. This method
+    // assumes that the
+    // subtrees are already heapified
+    void MinHeapify(int i) {
+        int l = left(i);
+        int r = right(i);
+        int smallest = i;
+        if (l < heap_size && less(harr[l], harr[i]))
+            smallest = l;
+        if (r < heap_size && less(harr[r], harr[smallest]))
+            smallest = r;
+        if (smallest != i) {
+            MinHeapNode<T> temp = harr[i];
+            harr[i] = harr[smallest];
+            harr[smallest] = temp;
+            MinHeapify(smallest);
+        }
+    }
 
-    // to get index of left child 
-    // of node at index i 
+    // to get index of left child
+    // of node at index i
     int left(int i) { return (2 * i + 1); }
 
-    // to get index of right child 
-    // of node at index i 
+    // to get index of right child
+    // of node at index i
     int right(int i) { return (2 * i + 2); }
 
-    // to get the root 
-    MinHeapNode getMin() { return harr[0]; }
+    // to get the root
+    MinHeapNode<T> getMin() { return harr[0]; }
 
-    // to replace root with new node 
-    // x and heapify() new root 
-    void replaceMin(MinHeapNode x)
-    {
+    // to replace root with new node
+    // x and heapify() new root
+    void replaceMin(MinHeapNode<T> x) {
         harr[0] = x;
         MinHeapify(0);
     }
-};
 
-// Constructor: Builds a heap from 
-// a given array a[] of given size 
-MinHeap::MinHeap(MinHeapNode a[], int size)
-{
-    heap_size = size;
-    harr = a; // store address of array 
-    int i = (heap_size - 1) / 2;
-    while (i >= 0) {
-        MinHeapify(i);
-        i--;
+    // to remove the root, the last
+    // node takes its place
+    void extractMin() {
+        harr[0] = harr[--heap_size];
+        MinHeapify(0);
     }
-}
-
-// A recursive method to heapify 
-// a subtree with root 
-// at given index. This method 
-// assumes that the 
-// subtrees are already heapified 
-void MinHeap::MinHeapify(int i)
-{
-    int l = left(i);
-    int r = right(i);
-    int smallest = i;
-    if (l < heap_size && harr[l].element < harr[i].element)
-        smallest = l;
-    if (r < heap_size && harr[r].element < harr[smallest].element)
-        smallest = r;
-    if (smallest != i) {
-        swap(&harr[i], &harr[smallest]);
-        MinHeapify(smallest);
+
+    int size() const { return heap_size; }
+
+private:
+    bool less(const MinHeapNode<T> &a, const MinHeapNode<T> &b) {
+        if (a.i != b.i)
+            return a.i < b.i;
+        return comp(a.element, b.element);
     }
-}
-
-// A utility function to swap two elements 
-void swap(MinHeapNode* x, MinHeapNode* y)
-{
-    MinHeapNode temp = *x;
-    *x = *y;
-    *y = temp;
-}
-
-// Merges two subarrays of arr[]. 
-// First subarray is arr[l..m] 
-// Second subarray is arr[m+1..r] 
-void merge(int arr[], int l, int m, int r)
-{
-    int i, j, k;
-    int n1 = m - l + 1;
-    int n2 = r - m;
-
-    /* create temp arrays */
-    int L[n1], R[n2];
-
-    /* Copy data to temp arrays L[] and R[] */
-    for (i = 0; i < n1; i++)
-        L[i] = arr[l + i];
-    for (j = 0; j < n2; j++)
-        R[j] = arr[m + 1 + j];
-
-    /* Merge the temp arrays back into arr[l..r]*/
-    // Initial index of first subarray 
-    i = 0;
-
-    // Initial index of second subarray 
-    j = 0;
-
-    // Initial index of merged subarray 
-    k = l;
-    while (i < n1 && j < n2)
-        arr[k++] = L[i] <= R[j] ? L[i++] : R[j++];
-
-    while (i < n1)
-        arr[k++] = L[i++];
-
-    while (j < n2)
-        arr[k++] = R[j++];
-}
-
-/* l is for left index and r is right index of the 
-   sub-array of arr to be sorted */
-void mergeSort(int arr[], int l, int r)
-{
-    if (l < r) {
-        // Same as (l+r)/2, but avoids overflow for 
-        // large l and h 
-        int m = l + (r - l) / 2;
-
-        // Sort first and second halves 
-        mergeSort(arr, l, m);
-        mergeSort(arr, m + 1, r);
-
-        merge(arr, l, m, r);
+};
+
+/*
+ 外部排序
+ T是定长的二进制记录，输入输出文件就是T数组的二进制表示(见BlockFile.hpp)。
+ 1. 生成初始顺串：每次读入内存预算能容纳的记录数，在内存中排好序后写成一个顺串文件；
+    或者用置换选择(replacementSelection)：内存里维护一个堆，随机输入时顺串平均长度是内存的两倍，
+    基本有序的输入只生成很少几个顺串；
+ 2. 多趟归并：一次最多同时打开fanIn个顺串，fanIn由内存预算(每一路两个I/O块)和进程的文件描述符上限共同决定，
+    顺串太多时先把每fanIn个合并成一个更长的顺串，直到剩下的顺串可以一趟归并到输出文件。
+ 生成顺串时读、排序、写三个阶段由不同线程流水线执行；归并时每一路输入都由后台I/O线程预读下一块，
+ 输出也在后台写盘，CPU和磁盘可以同时忙起来。
+ 所有中间文件都放在一个单独的临时目录里，排序结束后删除。
+ */
+template<typename T, typename Compare = std::less<T> >
+class ExternSort {
+public:
+    explicit ExternSort(size_t memoryBytes = 64 << 20, const std::string &tempBase = "", Compare comp = Compare())
+            : memoryBytes(memoryBytes), tempBase(tempBase), comp(comp), runs(0), passes(0), nextRunId(0) {}
+
+    ~ExternSort() { removeTempDir(); }
+
+    //每个文件读写缓冲区的大小
+    size_t blockBytes = 1 << 20;
+    //归并路数的上限，0表示只受内存和文件描述符限制
+    int maxFanIn = 0;
+    //生成顺串时用mmap读输入文件
+    bool useMmap = false;
+    //用置换选择生成顺串，适合基本有序的输入
+    bool replacementSelection = false;
+
+    void sort(const std::string &inputFile, const std::string &outputFile) {
+        makeTempDir();
+        runs = 0;
+        passes = 0;
+        std::vector<std::string> runFiles;
+        if (replacementSelection)
+            createReplacementRuns(inputFile, runFiles);
+        else
+            createInitialRuns(inputFile, runFiles);
+        runs = runFiles.size();
+        mergeRuns(runFiles, outputFile);
+        removeTempDir();
     }
-}
-
-FILE* openFile(char* fileName, char* mode)
-{
-    FILE* fp = fopen(fileName, mode);
-    if (fp == NULL) {
-        perror("Error while opening the file.\n");
-        exit(EXIT_FAILURE);
+
+    //一次内存排序的记录数，内存预算由流水线的RUN_BUFFERS个缓冲区平分
+    size_t runSize() const {
+        size_t n = memoryBytes > 2 * blockBytes ? (memoryBytes - 2 * blockBytes) / RUN_BUFFERS / sizeof(T) : 0;
+        return std::max((size_t) 1, std::min(n, (size_t) INT_MAX));
     }
-    return fp;
-}
-
-// Merges k sorted files. Names of files are assumed 
-// to be 1, 2, 3, ... k 
-void mergeFiles(char* output_file, int n, int k)
-{
-    FILE* in[k];
-    for (int i = 0; i < k; i++) {
-        char fileName[2];
-
-        // convert i to string 
-        snprintf(fileName, sizeof(fileName),
-                 "%d", i);
-
-        // Open output files in read mode. 
-        in[i] = openFile(fileName, "r");
+
+    //置换选择时堆的大小，输入和输出各留两个块做双缓冲
+    size_t heapSize() const {
+        size_t n = memoryBytes > 4 * blockBytes ? (memoryBytes - 4 * blockBytes) / sizeof(MinHeapNode<T>) : 0;
+        return std::max((size_t) 1, std::min(n, (size_t) INT_MAX));
     }
 
-    // FINAL OUTPUT FILE 
-    FILE* out = openFile(output_file, "w");
+    //一次归并同时打开的顺串个数
+    int fanIn() const {
+        //每一路和输出都是双缓冲，各占两个块
+        size_t byMemory = memoryBytes / (2 * blockBytes);
+        byMemory = byMemory > 1 ? byMemory - 1 : 1;    //留给输出
+        int k = (int) std::min(byMemory, maxOpenFiles());
+        if (maxFanIn > 0)
+            k = std::min(k, maxFanIn);
+        return std::max(k, 2);
+    }
 
-    // Create a min heap with k heap 
-    // nodes. Every heap node 
-    // has first element of scratch 
-    // output file 
-    MinHeapNode* harr = new MinHeapNode[k];
-    int i;
-    for (i = 0; i < k; i++) {
-        // break if no output file is empty and 
-        // index i will be no. of input files 
-        if (fscanf(in[i], "%d ", &harr[i].element) != 1)
-            break;
-
-        // Index of scratch output file 
-        harr[i].i = i;
+    //上一次排序生成的初始顺串个数
+    size_t runCount() const { return runs; }
+
+    //上一次排序的归并趟数
+    int mergePasses() const { return passes; }
+
+private:
+    //生成顺串时同时在读、排序、写的缓冲区个数
+    static const int RUN_BUFFERS = 3;
+
+    size_t memoryBytes;
+    std::string tempBase;
+    Compare comp;
+    std::string tempDir;
+    size_t runs;
+    int passes;
+    int nextRunId;
+
+    //进程的文件描述符上限，留一些给标准输入输出和输出文件
+    static size_t maxOpenFiles() {
+        struct rlimit rl;
+        if (getrlimit(RLIMIT_NOFILE, &rl) != 0 || rl.rlim_cur == RLIM_INFINITY)
+            return 1024;
+        return rl.rlim_cur > 32 ? (size_t) rl.rlim_cur - 16 : 2;
     }
-    // Create the heap 
-    MinHeap hp(harr, i);
-
-    int count = 0;
-
-    // Now one by one get the 
-    // minimum element from min 
-    // heap and replace it with 
-    // next element. 
-    // run till all filled input 
-    // files reach EOF 
-    while (count != i) {
-        // Get the minimum element 
-        // and store it in output file 
-        MinHeapNode root = hp.getMin();
-        fprintf(out, "%d ", root.element);
-
-        // Find the next element that 
-        // will replace current 
-        // root of heap. The next element 
-        // belongs to same 
-        // input file as the current min element. 
-        if (fscanf(in[root.i], "%d ",
-                   &root.element)
-            != 1) {
-            root.element = INT_MAX;
-            count++;
+
+    void makeTempDir() {
+        removeTempDir();
+        std::string base = tempBase;
+        if (base.empty()) {
+            const char *env = getenv("TMPDIR");
+            base = env != nullptr && env[0] != '\0' ? env : "/tmp";
+        }
+        std::string pattern = base + "/externsort-XXXXXX";
+        std::vector<char> name(pattern.begin(), pattern.end());
+        name.push_back('\0');
+        if (mkdtemp(name.data()) == nullptr) {
+            perror("Error while creating the temp directory.\n");
+            exit(EXIT_FAILURE);
         }
+        tempDir = name.data();
+        nextRunId = 0;
+    }
 
-        // Replace root with next 
-        // element of input file 
-        hp.replaceMin(root);
+    void removeTempDir() {
+        if (tempDir.empty())
+            return;
+        for (int i = 0; i < nextRunId; i++)
+            unlink(runName(i).c_str());
+        rmdir(tempDir.c_str());
+        tempDir.clear();
     }
 
-    // close input and output files 
-    for (int i = 0; i < k; i++)
-        fclose(in[i]);
-
-    fclose(out);
-}
-
-// Using a merge-sort algorithm, 
-// create the initial runs 
-// and divide them evenly among 
-// the output files 
-void createInitialRuns(
-        char* input_file, int run_size,
-        int num_ways)
-{
-    // For big input file 
-    FILE* in = openFile(input_file, "r");
-
-    // output scratch files 
-    FILE* out[num_ways];
-    char fileName[2];
-    for (int i = 0; i < num_ways; i++) {
-        // convert i to string 
-        snprintf(fileName, sizeof(fileName),
-                 "%d", i);
-
-        // Open output files in write mode. 
-        out[i] = openFile(fileName, "w");
+    std::string runName(int id) const {
+        char name[32];
+        snprintf(name, sizeof(name), "/run-%08d.bin", id);
+        return tempDir + name;
     }
 
-    // allocate a dynamic array large enough 
-    // to accommodate runs of size run_size 
-    int* arr = (int*)malloc(
-            run_size * sizeof(int));
+    std::string newRun() {
+        return runName(nextRunId++);
+    }
 
-    bool more_input = true;
-    int next_output_file = 0;
+    // Using the in-memory sort,
+    // create the initial runs,
+    // one scratch file per run
+    // 读、排序、写三个阶段流水线执行：读线程往空闲缓冲区里读下一个顺串，
+    // 当前线程用多线程快排排序，写线程把排好的顺串写到磁盘，三个缓冲区轮流使用
+    void createInitialRuns(const std::string &inputFile, std::vector<std::string> &runFiles) {
+        size_t n = runSize();
+        std::vector<std::vector<T> > buffers(RUN_BUFFERS, std::vector<T>(n));
+        std::vector<size_t> lengths(RUN_BUFFERS, 0);
+        std::vector<std::string> names(RUN_BUFFERS);
+        BlockingQueue<int> freeBuffers(RUN_BUFFERS), sortQueue(RUN_BUFFERS), writeQueue(RUN_BUFFERS);
+        for (int i = 0; i < RUN_BUFFERS; i++)
+            freeBuffers.push(i);
+
+        std::thread reader([&]() {
+            BlockReader<T> in(blockBytes);
+            MappedFile<T> *mapped = nullptr;
+            size_t mappedPos = 0;
+            if (useMmap)
+                mapped = new MappedFile<T>(inputFile.c_str());
+            else
+                in.open(inputFile.c_str());
+            int b;
+            while (freeBuffers.pop(b)) {
+                T *arr = buffers[b].data();
+                size_t m;
+                if (useMmap) {
+                    m = std::min(n, mapped->size() - mappedPos);
+                    std::copy(mapped->data() + mappedPos, mapped->data() + mappedPos + m, arr);
+                    mappedPos += m;
+                } else {
+                    m = in.read(arr, n);
+                }
+                if (m == 0)
+                    break;
+                lengths[b] = m;
+                sortQueue.push(b);
+            }
+            delete mapped;
+            sortQueue.close();
+        });
+
+        std::thread writer([&]() {
+            int b;
+            while (writeQueue.pop(b)) {
+                BlockWriter<T> out(names[b].c_str(), blockBytes);
+                out.write(buffers[b].data(), lengths[b]);
+                out.close();
+                freeBuffers.push(b);
+            }
+        });
+
+        QuickSortMuiltThread<T, Compare> sorter(comp);
+        int b;
+        while (sortQueue.pop(b)) {
+            sorter.sortAdvanced(buffers[b].data(), (int) lengths[b]);
+            //顺串按读入的顺序命名，归并时的稳定性不受流水线影响
+            names[b] = newRun();
+            runFiles.push_back(names[b]);
+            writeQueue.push(b);
+        }
+        writeQueue.close();
+        writer.join();
+        freeBuffers.close();
+        reader.join();
+
+        //空文件也输出一个空顺串，保证后面总会生成输出文件
+        if (runFiles.empty()) {
+            runFiles.push_back(newRun());
+            BlockWriter<T> out(runFiles.back().c_str(), blockBytes);
+        }
+    }
 
-    int i;
-    while (more_input) {
-        // write run_size elements 
-        // into arr from input file 
-        for (i = 0; i < run_size; i++) {
-            if (fscanf(in, "%d ", &arr[i]) != 1) {
-                more_input = false;
-                break;
+    /*
+     置换选择生成顺串
+     堆中每个节点记录它属于哪个顺串，堆按(顺串编号, 元素)排序。每次输出堆顶，再读入一个新元素：
+     新元素不小于刚输出的元素时还能放进当前顺串，否则只能放进下一个顺串。
+     堆顶的顺串编号变了，说明当前顺串已经结束。
+     */
+    void createReplacementRuns(const std::string &inputFile, std::vector<std::string> &runFiles) {
+        std::vector<MinHeapNode<T> > nodes(heapSize());
+        AsyncBlockReader<T> in(inputFile.c_str(), blockBytes);
+        int n = 0;
+        while (n < (int) nodes.size() && in.next(nodes[n].element))
+            nodes[n++].i = 0;
+        MinHeap<T, Compare> heap(nodes.data(), n, comp);
+
+        AsyncBlockWriter<T> out(blockBytes);
+        int run = -1;
+        T x;
+        while (heap.size() > 0) {
+            MinHeapNode<T> top = heap.getMin();
+            if (top.i != run) {
+                run = top.i;
+                runFiles.push_back(newRun());
+                out.open(runFiles.back().c_str());
+            }
+            out.write(&top.element, 1);
+            if (in.next(x)) {
+                MinHeapNode<T> node;
+                node.element = x;
+                node.i = comp(x, top.element) ? run + 1 : run;
+                heap.replaceMin(node);
+            } else {
+                heap.extractMin();
             }
         }
+        out.close();
 
-        // sort array using merge sort 
-        mergeSort(arr, 0, i - 1);
+        if (runFiles.empty()) {
+            runFiles.push_back(newRun());
+            BlockWriter<T> empty(runFiles.back().c_str(), blockBytes);
+        }
+    }
 
-        // write the records to the 
-        // appropriate scratch output file 
-        // can't assume that the loop 
-        // runs to run_size 
-        // since the last run's length 
-        // may be less than run_size 
-        for (int j = 0; j < i; j++)
-            fprintf(out[next_output_file],
-                    "%d ", arr[j]);
+    //顺串多于fanIn时，先把每fanIn个合并成一个更长的顺串，最后一趟直接输出到outputFile
+    void mergeRuns(std::vector<std::string> runFiles, const std::string &outputFile) {
+        int k = fanIn();
+        while ((int) runFiles.size() > k) {
+            std::vector<std::string> next;
+            for (size_t i = 0; i < runFiles.size(); i += k) {
+                size_t j = std::min(runFiles.size(), i + k);
+                std::vector<std::string> group(runFiles.begin() + i, runFiles.begin() + j);
+                if (group.size() == 1) {
+                    next.push_back(group[0]);
+                    continue;
+                }
+                next.push_back(newRun());
+                mergeFiles(group, next.back());
+            }
+            runFiles.swap(next);
+            passes++;
+        }
+        mergeFiles(runFiles, outputFile);
+        passes++;
+    }
 
-        next_output_file++;
+    // Merges k sorted files into output,
+    // the inputs are deleted afterwards
+    void mergeFiles(const std::vector<std::string> &inputs, const std::string &output) {
+        int k = (int) inputs.size();
+        std::vector<AsyncBlockReader<T> *> readers;
+        for (int i = 0; i < k; i++)
+            readers.push_back(new AsyncBlockReader<T>(inputs[i].c_str(), blockBytes));
+        std::vector<ReaderSource> sources;
+        for (int i = 0; i < k; i++)
+            sources.push_back(ReaderSource(readers[i]));
+
+        AsyncBlockWriter<T> out(output.c_str(), blockBytes);
+        LoserTree<T, Compare> tree(k, comp);
+        tree.init(sources.data());
+
+        const int batchSize = 4096;
+        std::vector<T> batch(batchSize);
+        int m;
+        while ((m = tree.mergeBatch(sources.data(), batch.data(), batchSize)) > 0)
+            out.write(batch.data(), m);
+        out.close();
+
+        for (int i = 0; i < k; i++) {
+            delete readers[i];
+            unlink(inputs[i].c_str());
+        }
     }
 
-    // close input and output files 
-    for (int i = 0; i < num_ways; i++)
-        fclose(out[i]);
-
-    fclose(in);
-}
-
-// For sorting data stored on disk 
-void externalSort(
-        char* input_file, char* output_file,
-        int num_ways, int run_size)
-{
-    // read the input file, 
-    // create the initial runs, 
-    // and assign the runs to 
-    // the scratch output files 
-    createInitialRuns(input_file,
-                      run_size, num_ways);
-
-    // Merge the runs using 
-    // the K-way merging 
-    mergeFiles(output_file, run_size, num_ways);
-}
-
-// Driver program to test above 
-int main()
-{
-    // No. of Partitions of input file. 
-    int num_ways = 10;
-
-    // The size of each partition 
-    int run_size = 1000;
-
-    char input_file[] = "input.txt";
-    char output_file[] = "output.txt";
-
-    FILE* in = openFile(input_file, "w");
-
-    srand(time(NULL));
-
-    // generate input 
-    for (int i = 0; i < num_ways * run_size; i++)
-        fprintf(in, "%d ", rand());
-
-    fclose(in);
-
-    externalSort(input_file, output_file, num_ways,
-                 run_size);
-    sort()
-    return 0;
-}
\ No newline at end of file
+    //AsyncBlockReader不能拷贝，败者树的输入用指针包一层
+    struct ReaderSource {
+        AsyncBlockReader<T> *reader;
+
+        explicit ReaderSource(AsyncBlockReader<T> *reader) : reader(reader) {}
+
+        bool next(T &x) { return reader->next(x); }
+    };
+};
+
+#endif //EXTERNSORT_HPP
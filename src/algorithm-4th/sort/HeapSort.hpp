@@ -1,8 +1,35 @@
 #ifndef HEAPSORT_HPP
 #define HEAPSORT_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+ d叉堆的叉数：一个节点的所有孩子连续存放，取能让一组孩子放进一个缓存行(64字节)的最大叉数，只在2、4、8里选。
+ 叉数越大树越矮，下沉时访问的缓存行越少，但每层要多做几次比较。
+ */
 template<typename T>
+struct DHeapArity {
+    static const int CACHE_LINE = 64;
+    static const int value = sizeof(T) * 8 <= CACHE_LINE ? 8 : sizeof(T) * 4 <= CACHE_LINE ? 4 : 2;
+};
+
+/*
+ 堆排序
+   - sortIterative/sortRecursive: 经典的二叉堆；
+   - sortAdvanced: ARITY叉堆(默认由DHeapArity按元素大小选)，
+     1. 节点i的孩子是ARITY*i+1 ~ ARITY*i+ARITY，跳过数组开头几个元素让每组孩子都对齐到缓存行，
+        跳过的元素最后再归并进来；
+     2. 取堆顶时用Floyd的自底向上下沉：空洞沿着较大的孩子一路走到叶子，不和被下沉的元素比较，
+        再把末尾元素从叶子处上浮回来，末尾元素通常很小，上浮一两层就停了，比较次数接近减半；
+     3. 每下沉一层就预取孙子节点所在的缓存行。
+ */
+template<typename T, int ARITY = DHeapArity<T>::value>
 class HeapSort {
+    static_assert(ARITY == 2 || ARITY == 4 || ARITY == 8, "heap arity must be 2, 4 or 8");
+
 public:
     void sortIterative(T *arr, const int len) {
         heapSortIterative(arr, len);
@@ -44,12 +71,16 @@ private:
     }
 
     void DHeapSort(T *arr, const int len) {
-        buildDHeap(arr, len);
-        for (int i = len - 1; i >= 0; i--) {
-            swap(arr, 0, i);
-            // assert(isSorted(arr, i, len - 1));
-            ShiftDownInDHeap(arr, 0, i);
-        }
+        if (len < 2)
+            return;
+        const int offset = alignedOffset(arr, len);
+        T *heap = arr + offset;
+        const int n = len - offset;
+        buildDHeap(heap, n);
+        for (int i = n; i > 1; i--)
+            popDHeap(heap, i);
+        // assert(isSorted(heap, n));
+        mergePrefix(arr, offset, len);
     }
 
 
@@ -125,39 +156,144 @@ private:
     }
 
 
-    int Dchild = 5; //假设是5叉堆
+    static const int CACHE_LINE = DHeapArity<T>::CACHE_LINE;
+    //一个缓存行能放几个元素，预取时按这个步长走
+    static const int LINE_ELEMENTS = sizeof(T) < (size_t) CACHE_LINE ? CACHE_LINE / sizeof(T) : 1;
 
-    //在长度为len的数组中，调整parent，使其恢复堆的性质
-    void ShiftDownInDHeap(T *arr, int parent, int len) {
-        int lo = Dchild * parent + 1;
-        //base case 没有孩子节点
-        if (lo >= len)
-            return;
-        //选择父节点、所有孩子中最大的那个元素
-        int hi = lo + Dchild - 1;
-        int max = parent;
-        for (int i = lo; i < len && i <= hi; i++) {
-            if (arr[max] < arr[i])
+    /*
+     节点i的第一个孩子在ARITY*i+1，这一组孩子的地址是arr+1再加上ARITY*i个元素，
+     只要arr+1对齐到一组孩子的大小(超过缓存行时按缓存行对齐)，所有组就都对齐了。
+     返回要跳过的元素个数，元素大小不是2的幂时不做对齐。
+     */
+    static int alignedOffset(const T *arr, const int len) {
+        const size_t size = sizeof(T);
+        const size_t group = ARITY * size < (size_t) CACHE_LINE ? ARITY * size : (size_t) CACHE_LINE;
+        if ((size & (size - 1)) != 0 || group % size != 0)
+            return 0;
+        size_t misaligned = ((uintptr_t) (arr + 1)) % group;
+        if (misaligned == 0 || misaligned % size != 0)
+            return 0;
+        int offset = (int) ((group - misaligned) / size);
+        return offset < len ? offset : 0;
+    }
+
+    //预取节点parent的孙子：它们在数组里是连续的ARITY*ARITY个元素
+    static void prefetchGrandchildren(const T *heap, const int firstChild, const int len) {
+#if defined(__GNUC__) || defined(__clang__)
+        long long lo = (long long) ARITY * firstChild + 1;
+        long long hi = lo + ARITY * ARITY;
+        if (hi > len)
+            hi = len;
+        for (long long i = lo; i < hi; i += LINE_ELEMENTS)
+            __builtin_prefetch(heap + i);
+#else
+        (void) heap;
+        (void) firstChild;
+        (void) len;
+#endif
+    }
+
+    /*
+     [first, end)里最大的孩子
+     孩子是满的时候循环次数是常量，编译器可以展开；比较结果是随机的，用条件选择代替分支，
+     编译成cmov，避免分支预测失败
+     */
+    static int maxChild(const T *heap, const int first, const int end) {
+        if (end - first == ARITY) {
+            if (ARITY == 2)
+                return first + (heap[first] < heap[first + 1] ? 1 : 0);
+            const T *max = heap + first;
+            for (int i = 1; i < ARITY; i++)
+                max = *max < heap[first + i] ? heap + first + i : max;
+            return (int) (max - heap);
+        }
+        int max = first;
+        for (int i = first + 1; i < end; i++)
+            if (heap[max] < heap[i])
                 max = i;
+        return max;
+    }
+
+public:
+    //ARITY叉大顶堆的基本操作，Select的top-K也用
+    //在长度为len的堆中，调整parent，使其恢复堆的性质
+    static void ShiftDownInDHeap(T *heap, int parent, const int len) {
+        T target = std::move(heap[parent]);
+        while (true) {
+            int first = ARITY * parent + 1;
+            if (first >= len)
+                break;
+            int max = maxChild(heap, first, first + ARITY < len ? first + ARITY : len);
+            if (!(target < heap[max]))
+                break;
+            heap[parent] = std::move(heap[max]);
+            parent = max;
         }
-        //如果不是父节点，则交换，并对孩子节点接续做heapify
-        if (parent != max) {
-            swap(arr, parent, max);
-            ShiftDownInDHeap(arr, max, len);
+        heap[parent] = std::move(target);
+    }
+
+    //自底向上(Floyd)：把堆顶放到heap[len-1]，剩下的len-1个元素重新组成堆
+    static void popDHeap(T *heap, const int len) {
+        T last = std::move(heap[len - 1]);
+        heap[len - 1] = std::move(heap[0]);
+        const int n = len - 1;
+        //空洞沿着较大的孩子一路走到叶子
+        int hole = 0;
+        while (true) {
+            int first = ARITY * hole + 1;
+            if (first >= n)
+                break;
+            prefetchGrandchildren(heap, first, n);
+            int max = maxChild(heap, first, first + ARITY < n ? first + ARITY : n);
+            heap[hole] = std::move(heap[max]);
+            hole = max;
+        }
+        //原来的末尾元素从空洞处上浮
+        while (hole > 0) {
+            int parent = (hole - 1) / ARITY;
+            if (!(heap[parent] < last))
+                break;
+            heap[hole] = std::move(heap[parent]);
+            hole = parent;
         }
+        heap[hole] = std::move(last);
     }
 
+    static void buildDHeap(T *heap, const int len) {
+        for (int i = (len - 2) / ARITY; i >= 0; i--)
+            ShiftDownInDHeap(heap, i, len);
+    }
 
-    void buildDHeap(T *arr, int len) {
-        for (int i = (len - 1) / Dchild; i >= 0; i--)
-            ShiftDownInDHeap(arr, i, len);
+private:
+    //为了对齐跳过的前offset(< ARITY)个元素：插入排序后归并进已经有序的arr[offset, len)
+    void mergePrefix(T *arr, const int offset, const int len) {
+        if (offset == 0)
+            return;
+        std::vector<T> prefix;
+        prefix.reserve(offset);
+        for (int i = 0; i < offset; i++) {
+            int j = i;
+            prefix.push_back(std::move(arr[i]));
+            T target = std::move(prefix[j]);
+            for (; j > 0 && target < prefix[j - 1]; j--)
+                prefix[j] = std::move(prefix[j - 1]);
+            prefix[j] = std::move(target);
+        }
+        //写的位置i+k-offset不会超过读的位置k，可以原地归并
+        int i = 0, k = offset, out = 0;
+        while (i < offset) {
+            if (k < len && arr[k] < prefix[i])
+                arr[out++] = std::move(arr[k++]);
+            else
+                arr[out++] = std::move(prefix[i++]);
+        }
     }
 
 
     void swap(T *arr, const int i, const int j) {
-        T k = arr[i];
-        arr[i] = arr[j];
-        arr[j] = k;
+        T k = std::move(arr[i]);
+        arr[i] = std::move(arr[j]);
+        arr[j] = std::move(k);
     }
 
     bool isSorted(T *arr, const int lo, const int hi) {
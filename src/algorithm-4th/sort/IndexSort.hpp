@@ -0,0 +1,181 @@
+#ifndef INDEXSORT_HPP
+#define INDEXSORT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "QuickSort.hpp"
+#include "RadixSort.hpp"
+
+/*
+ 索引排序：记录很大、只按其中一个小字段排序时，搬动整条记录的代价远大于比较
+   - sortIterative: 把(键, 下标)对拷出来排序，排序过程中只搬动这些小的对；
+   - sortRecursive: 只排序下标数组，比较时再通过下标去记录里取键(间接排序)，连键都不拷贝；
+   - sortAdvanced: 键是整数或浮点数时，(键, 下标)对用并行的RadixSort排序，否则同sortIterative。
+ 三种方式都先得到一个排列perm，perm[i]是排好序后第i个位置上应该放的原下标，
+ 最后沿着置换的环把记录移动到位，每条记录只移动一次。键相同的记录保持原来的顺序(稳定)。
+ KeyOf是从记录里取键的函数对象，键需要支持operator<。
+ 浮点键三种方式用同一个顺序：-0.0和+0.0相等(保持原来的顺序)，NaN比所有数都大，NaN之间相等。
+ */
+template<typename T, typename KeyOf>
+class IndexSort {
+public:
+    typedef typename std::decay<decltype(std::declval<KeyOf>()(std::declval<const T &>()))>::type Key;
+
+    explicit IndexSort(KeyOf keyOf = KeyOf()) : keyOf(keyOf) {}
+
+    void sortIterative(T *arr, const int len) {
+        std::vector<int> perm = keyIndexPermutation(arr, len);
+        applyPermutation(arr, perm);
+    }
+
+    void sortRecursive(T *arr, const int len) {
+        std::vector<int> perm = indirectPermutation(arr, len);
+        applyPermutation(arr, perm);
+    }
+
+    void sortAdvanced(T *arr, const int len) {
+        std::vector<int> perm = radixPermutation(arr, len, std::integral_constant<bool, RADIX_KEY>());
+        applyPermutation(arr, perm);
+    }
+
+public:
+    //只求排序后的下标顺序，不移动记录
+    std::vector<int> sortedPermutation(const T *arr, const int len) {
+        return radixPermutation(arr, len, std::integral_constant<bool, RADIX_KEY>());
+    }
+
+    /*
+     按perm重排数组：排好后arr[i]是原来的arr[perm[i]]
+     从i出发沿着i <- perm[i] <- perm[perm[i]]...这个环把记录依次挪过来，环上第一条记录先移到临时变量里，
+     每条记录只移动一次。处理过的位置把perm[j]置成j，函数返回时perm变成恒等排列。
+     */
+    static void applyPermutation(T *arr, std::vector<int> &perm) {
+        const int len = (int) perm.size();
+        for (int i = 0; i < len; i++) {
+            if (perm[i] == i)
+                continue;
+            T tmp = std::move(arr[i]);
+            int j = i;
+            while (perm[j] != i) {
+                int k = perm[j];
+                arr[j] = std::move(arr[k]);
+                perm[j] = j;
+                j = k;
+            }
+            arr[j] = std::move(tmp);
+            perm[j] = j;
+        }
+    }
+
+private:
+    //整数和float、double键可以直接用RadixKey映射成无符号整数
+    static const bool RADIX_KEY = (std::is_integral<Key>::value && !std::is_same<Key, bool>::value)
+                                  || std::is_same<Key, float>::value || std::is_same<Key, double>::value;
+
+    KeyOf keyOf;
+
+    static bool keyLess(const Key &a, const Key &b, std::false_type) {
+        return a < b;
+    }
+
+    static bool keyLess(const Key &a, const Key &b, std::true_type) {
+        return a < b || (std::isnan(b) && !std::isnan(a));
+    }
+
+    static bool keyLess(const Key &a, const Key &b) {
+        return keyLess(a, b, std::is_floating_point<Key>());
+    }
+
+    //键相同时按下标比较，排序不稳定也能得到稳定的结果
+    struct KeyIndex {
+        Key key;
+        int index;
+
+        bool operator<(const KeyIndex &that) const {
+            if (keyLess(key, that.key))
+                return true;
+            if (keyLess(that.key, key))
+                return false;
+            return index < that.index;
+        }
+
+        bool operator>(const KeyIndex &that) const {
+            return that < *this;
+        }
+    };
+
+    //RadixKey按位模式排，-0.0在+0.0前面，NaN按符号分在两头；先换成一个代表再取键，和keyLess的顺序一致
+    struct KeyIndexRadixKey {
+        typename std::decay<decltype(RadixKey<Key>()(std::declval<const Key &>()))>::type
+        operator()(const KeyIndex &x) const {
+            return RadixKey<Key>()(canonical(x.key, std::is_floating_point<Key>()));
+        }
+
+        static Key canonical(const Key &k, std::false_type) {
+            return k;
+        }
+
+        static Key canonical(const Key &k, std::true_type) {
+            if (k == 0)
+                return Key(0);
+            return std::isnan(k) ? std::numeric_limits<Key>::quiet_NaN() : k;
+        }
+    };
+
+    std::vector<KeyIndex> keyIndexPairs(const T *arr, const int len) {
+        std::vector<KeyIndex> pairs(len);
+        for (int i = 0; i < len; i++) {
+            pairs[i].key = keyOf(arr[i]);
+            pairs[i].index = i;
+        }
+        return pairs;
+    }
+
+    static std::vector<int> indexesOf(const std::vector<KeyIndex> &pairs) {
+        std::vector<int> perm(pairs.size());
+        for (size_t i = 0; i < pairs.size(); i++)
+            perm[i] = pairs[i].index;
+        return perm;
+    }
+
+    std::vector<int> keyIndexPermutation(const T *arr, const int len) {
+        std::vector<KeyIndex> pairs = keyIndexPairs(arr, len);
+        QuickSort<KeyIndex>().sortAdvanced(pairs.data(), len);
+        return indexesOf(pairs);
+    }
+
+    std::vector<int> indirectPermutation(const T *arr, const int len) {
+        std::vector<int> perm(len);
+        for (int i = 0; i < len; i++)
+            perm[i] = i;
+        KeyOf &key = keyOf;
+        std::sort(perm.begin(), perm.end(), [arr, &key](int a, int b) {
+            if (keyLess(key(arr[a]), key(arr[b])))
+                return true;
+            if (keyLess(key(arr[b]), key(arr[a])))
+                return false;
+            return a < b;
+        });
+        return perm;
+    }
+
+    //LSD基数排序本身是稳定的，下标天然保持升序
+    std::vector<int> radixPermutation(const T *arr, const int len, std::true_type) {
+        std::vector<KeyIndex> pairs = keyIndexPairs(arr, len);
+        RadixSort<KeyIndex, KeyIndexRadixKey>().sortAdvanced(pairs.data(), len);
+        return indexesOf(pairs);
+    }
+
+    std::vector<int> radixPermutation(const T *arr, const int len, std::false_type) {
+        return keyIndexPermutation(arr, len);
+    }
+};
+
+
+#endif //INDEXSORT_HPP
@@ -1,6 +1,8 @@
 #ifndef INSERTSORT_HPP
 #define INSERTSORT_HPP
 
+#include <algorithm>
+#include <utility>
 
 template<typename T>
 class InsertSort {
@@ -64,17 +66,17 @@ private:
     }
 
     inline void insertOperationAdvance(T *arr, int i) {
-        T last = arr[i];    //arr[i]这个值会被覆盖，所以临时保存一份
+        T last = std::move(arr[i]);    //arr[i]这个值会被覆盖，所以临时保存一份
         int j = i - 1;
         while (j >= 0 && last < arr[j]) {
-            arr[j + 1] = arr[j];
+            arr[j + 1] = std::move(arr[j]);
             j--;
         }
-        arr[j + 1] = last;
+        arr[j + 1] = std::move(last);
     }
 
     //nums[0...len)有序，在其中搜索插入位置，使用二分法
-    int searchInsertPos(T *nums, const int len, T target) {
+    int searchInsertPos(T *nums, const int len, const T &target) {
         // int left = 0;
         // // 因为有可能数组的最后一个元素的位置的下一个是我们要找的，故右边界是 len
         // int right = len;
@@ -90,24 +92,24 @@ private:
         //     }
         // }
         // return left;
-        return lower_bound(nums, nums+len, target) - nums;
+        return std::lower_bound(nums, nums+len, target) - nums;
     }
 
     void binaryInsertSort(T *arr, const int len) {
         for (int i = 1; i < len; i++) {
-            T target = arr[i];
+            T target = std::move(arr[i]);
             int p = searchInsertPos(arr, i, target);
             //把[p...i-1]位置的都移动到[p+1...i]这个位置
             for (int j = i - 1; j >= p; j--)
-                arr[j + 1] = arr[j];
-            arr[p] = target;
+                arr[j + 1] = std::move(arr[j]);
+            arr[p] = std::move(target);
         }
     }
 
     void swap(T *arr, const int i, const int j) {
-        T k = arr[i];
-        arr[i] = arr[j];
-        arr[j] = k;
+        T k = std::move(arr[i]);
+        arr[i] = std::move(arr[j]);
+        arr[j] = std::move(k);
     }
 
     bool isSorted(T *arr, const int lo, const int hi) {
@@ -0,0 +1,136 @@
+#ifndef LOSERTREE_HPP
+#define LOSERTREE_HPP
+
+#include <functional>
+#include <vector>
+
+/*
+ 败者树(tournament tree)，用于K路归并
+ tree[1...k-1]是内部节点，记录这一场比赛的败者；tree[0]记录最终的胜者，也就是当前最小元素所在的路。
+ 第i路对应的叶子是虚拟下标i+k，它的父节点是(i+k)/2。
+ 胜者输出之后，只需要让它那一路的下一个元素从叶子一路比到根，每一层和节点里的败者比一次，
+ 一共log(K)次比较；而堆的pop+push或者下沉操作每一层要比两次。
+ keys和tree都是连续数组，整棵树只有几个cache line。
+ */
+template<typename T, typename Compare = std::less<T> >
+class LoserTree {
+public:
+    explicit LoserTree(int k, Compare comp = Compare()) : k(k), tree(k > 0 ? k : 1, 0), keys(k), live(k, 0),
+                                                          comp(comp) {}
+
+    //从每一路读入第一个元素并建树，Source需要提供bool next(T &x)
+    template<typename Source>
+    void init(Source *sources) {
+        for (int i = 0; i < k; i++)
+            live[i] = sources[i].next(keys[i]) ? 1 : 0;
+        build();
+    }
+
+    //手动设置第i路的第一个元素，全部设置完之后调用build()
+    void set(int i, const T &key) {
+        keys[i] = key;
+        live[i] = 1;
+    }
+
+    void build() {
+        tree[0] = k > 0 ? build(1) : 0;
+    }
+
+    bool empty() const { return k == 0 || !live[tree[0]]; }
+
+    //当前最小元素所在的路
+    int top() const { return tree[0]; }
+
+    const T &topKey() const { return keys[tree[0]]; }
+
+    //胜者所在的路读入了下一个元素
+    void replaceTop(const T &key) {
+        int w = tree[0];
+        keys[w] = key;
+        replay(w);
+    }
+
+    //胜者所在的路已经读完了
+    void popTop() {
+        int w = tree[0];
+        live[w] = 0;
+        replay(w);
+    }
+
+    //批量输出：最多向out写n个元素，返回实际写出的个数，返回值小于n说明所有路都读完了
+    template<typename Source>
+    int mergeBatch(Source *sources, T *out, int n) {
+        int m = 0;
+        while (m < n && !empty()) {
+            int w = tree[0];
+            out[m++] = keys[w];
+            if (!sources[w].next(keys[w]))
+                live[w] = 0;
+            replay(w);
+        }
+        return m;
+    }
+
+private:
+    int k;
+    std::vector<int> tree;
+    std::vector<T> keys;
+    std::vector<char> live;    //这一路是否还有元素，读完的路比任何元素都大
+    Compare comp;
+
+    //a是否打败b，相等时下标小的获胜，保证归并是稳定的
+    bool beats(int a, int b) const {
+        if (!live[a]) return false;
+        if (!live[b]) return true;
+        if (comp(keys[a], keys[b])) return true;
+        if (comp(keys[b], keys[a])) return false;
+        return a < b;
+    }
+
+    //返回以node为根的子树的胜者，败者留在node中
+    int build(int node) {
+        if (node >= k)
+            return node - k;
+        int l = build(node << 1);
+        int r = build((node << 1) + 1);
+        if (beats(l, r)) {
+            tree[node] = r;
+            return l;
+        }
+        tree[node] = l;
+        return r;
+    }
+
+    //第i路的新元素从叶子向上重赛
+    void replay(int i) {
+        int winner = i;
+        for (int node = (i + k) >> 1; node > 0; node >>= 1) {
+            if (beats(tree[node], winner)) {
+                int t = tree[node];
+                tree[node] = winner;
+                winner = t;
+            }
+        }
+        tree[0] = winner;
+    }
+};
+
+//内存中的有序区间[cur, end)，作为败者树的一路输入
+template<typename T>
+struct RangeSource {
+    const T *cur;
+    const T *end;
+
+    RangeSource() : cur(nullptr), end(nullptr) {}
+
+    RangeSource(const T *begin, const T *end) : cur(begin), end(end) {}
+
+    bool next(T &x) {
+        if (cur == end)
+            return false;
+        x = *cur++;
+        return true;
+    }
+};
+
+#endif //LOSERTREE_HPP
@@ -1,6 +1,14 @@
 #ifndef MERGESORT_HPP
 #define MERGESORT_HPP
 
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SortingNetwork.hpp"
+#include "WorkStealingPool.hpp"
+
 using namespace std;
 
 template<typename T>
@@ -15,13 +23,21 @@ public:
     }
 
     void sortAdvanced(T *arr, const int len) {
-        mergeSort3Way(arr, len);
+        timSort(arr, len);
     }
 
     void mergeSortIterative(T *arr, const int len) {
         T *aux = new T[len];
+        //支持SIMD排序网络的类型先把每一小块排好，从块长开始归并
+        int block = Network::maxLength();
+        if (block > 0) {
+            for (int lo = 0; lo < len; lo += block)
+                Network::sort(arr + lo, min(block, len - lo));
+        } else {
+            block = 1;
+        }
         //首先归并长度为1的，将其变成2；然后我们应该归并长度为2的，将其变成4。所以有sz+sz
-        for (int sz = 1; sz < len; sz = sz + sz) {//执行归并过程merge[lo, lo+sz, lo+2sz]
+        for (int sz = block; sz < len; sz = sz + sz) {//执行归并过程merge[lo, lo+sz, lo+2sz]
             for (int lo = 0; lo < len - sz; lo += sz + sz) {
                 //这里因为lo+sz+sz可能超出了数组范围，所以进行一下比较。
                 merge2Ways(arr, lo, lo + sz - 1, min(lo + sz + sz - 1, len - 1), aux);
@@ -43,7 +59,249 @@ public:
         // assert(isSorted(arr, len));
     }
 
+    /*
+     TimSort风格的自适应稳定归并排序
+       1. 找自然有序段(run)：非降序的段直接用，严格降序的段原地翻转(严格才能保证稳定)，
+          太短的段用二分插入排序补到minRun长；各线程分段并行地找；
+       2. 相邻的run两两归并，同一轮里的归并互不相干，交给线程池并行；
+          剩下的几个大归并再按二分查找拆成两个独立的小归并并行做；
+       3. 归并时先跳过左段里本来就在正确位置的前缀和右段的后缀，只把剩下的左段拷到辅助数组；
+          一边连续赢了minGallop次就切换成倍增查找，整段整段地搬；
+          整数类型的短归并、以及长时间没有一边连续赢的归并，剩下的部分交给SIMD排序网络归并。
+     已经有序或几乎有序的数组只有很少的run，接近O(n)。相等的元素总是左边的先输出，排序是稳定的。
+     */
+    void timSort(T *arr, const int len) {
+        if (len < 2)
+            return;
+        TaskGroup group;
+        std::vector<int> runs = findRuns(arr, len, group);
+        T *aux = new T[len];
+        //runs[k]是第k个run的起点，最后一个元素是len
+        int tasks = (int) group.threadPool().size() * 4;
+        while (runs.size() > 2) {
+            //这一轮要做的归并按顺序分成若干批，每批一个任务，避免底层大量很短的归并各占一个任务
+            int pairs = (int) (runs.size() - 1) / 2;
+            int batches = std::min(pairs, tasks);
+            const std::vector<int> *bound = &runs;
+            for (int b = 0; b < batches; b++) {
+                int first = (int) ((long long) pairs * b / batches), last = (int) ((long long) pairs * (b + 1) / batches);
+                group.run([this, arr, bound, first, last, aux, &group]() {
+                    for (int p = first; p < last; p++)
+                        parallelMerge(arr, (*bound)[2 * p], (*bound)[2 * p + 1], (*bound)[2 * p + 2], aux, group);
+                });
+            }
+            group.wait();
+            std::vector<int> next;
+            for (size_t k = 0; k + 1 < runs.size(); k += 2)
+                next.push_back(runs[k]);
+            next.push_back(len);
+            runs.swap(next);
+        }
+        delete[] aux;
+        // assert(isSorted(arr, len));
+    }
+
 private:
+    /*
+     排序网络不稳定，只有相等就完全一样的整数类型可以用；
+     浮点数的-0.0和+0.0相等却能区分，交给排序网络会打乱它们原来的顺序，走标量的二分插入和归并
+     */
+    struct NoNetwork {
+        static int maxLength() { return 0; }
+
+        static bool sort(T *, const int) { return false; }
+
+        static bool merge(const T *, const int, const T *, const int, T *) { return false; }
+    };
+
+    typedef typename std::conditional<std::is_integral<T>::value, SortingNetwork<T>, NoNetwork>::type Network;
+
+    //短于这个长度的数组不再分段找run，短于这个长度的归并不再拆分
+    static const int PARALLEL_CUTOFF = 1 << 16;
+    static const int MIN_GALLOP = 7;
+    static const int SIMD_MERGE_STEPS = 64;
+    static const int SIMD_MERGE_LENGTH = 4096;
+
+    //TimSort的minRun：把len不断减半到[32, 64)之间，让run的个数接近2的幂，两两归并时比较均衡
+    static int minRunLength(int len) {
+        int r = 0;
+        while (len >= 64) {
+            r |= len & 1;
+            len >>= 1;
+        }
+        return len + r;
+    }
+
+    std::vector<int> findRuns(T *arr, const int len, TaskGroup &group) {
+        //有排序网络的类型一次能排好一整块，短run直接补到块长
+        int minRun = std::max(minRunLength(len), Network::maxLength());
+        int chunks = (int) std::min<long long>(group.threadPool().size(), len / PARALLEL_CUTOFF);
+        chunks = std::max(chunks, 1);
+        std::vector<std::vector<int> > chunkRuns(chunks);
+        for (int c = 0; c < chunks; c++) {
+            int lo = (int) ((long long) len * c / chunks), hi = (int) ((long long) len * (c + 1) / chunks);
+            std::vector<int> *out = &chunkRuns[c];
+            group.run([this, arr, lo, hi, minRun, out]() {
+                findRuns(arr, lo, hi, minRun, *out);
+            });
+        }
+        group.wait();
+        std::vector<int> runs;
+        for (int c = 0; c < chunks; c++)
+            runs.insert(runs.end(), chunkRuns[c].begin(), chunkRuns[c].end());
+        runs.push_back(len);
+        return runs;
+    }
+
+    void findRuns(T *arr, const int lo, const int hi, const int minRun, std::vector<int> &runs) {
+        int i = lo;
+        while (i < hi) {
+            int end = countRunAndMakeAscending(arr, i, hi);
+            if (end - i < minRun) {
+                //整数相等的值无法区分，可以直接用不稳定的排序网络
+                int force = std::min(hi, i + minRun);
+                if (!Network::sort(arr + i, force - i))
+                    binaryInsertSort(arr, i, force, end);
+                end = force;
+            }
+            runs.push_back(i);
+            i = end;
+        }
+    }
+
+    //返回从lo开始的run的终点(不含)，严格降序的run翻转成升序
+    int countRunAndMakeAscending(T *arr, const int lo, const int hi) {
+        int i = lo + 1;
+        if (i == hi)
+            return hi;
+        if (arr[i] < arr[lo]) {
+            while (i < hi && arr[i] < arr[i - 1])
+                i++;
+            std::reverse(arr + lo, arr + i);
+        } else {
+            while (i < hi && !(arr[i] < arr[i - 1]))
+                i++;
+        }
+        return i;
+    }
+
+    //arr[lo...start)已经有序，把arr[start...hi)依次插入，插在相等元素的后面
+    void binaryInsertSort(T *arr, const int lo, const int hi, const int start) {
+        for (int i = start; i < hi; i++) {
+            T pivot = std::move(arr[i]);
+            T *pos = std::upper_bound(arr + lo, arr + i, pivot);
+            std::move_backward(pos, arr + i, arr + i + 1);
+            *pos = std::move(pivot);
+        }
+    }
+
+    /*
+     归并arr[lo...mid)和arr[mid...hi)
+     区间足够大时取较长一段的中点作为key，在另一段里二分找到key的位置，旋转之后变成两个独立的归并：
+     左边的元素不大于key，右边的元素不小于key，和key相等的元素左段的在前、右段的在后，不破坏稳定性。
+     */
+    void parallelMerge(T *arr, int lo, int mid, int hi, T *aux, TaskGroup &group) {
+        while (hi - lo > PARALLEL_CUTOFF && lo < mid && mid < hi) {
+            int m1, m2;
+            if (mid - lo >= hi - mid) {
+                m1 = lo + ((mid - lo) >> 1);
+                m2 = (int) (std::lower_bound(arr + mid, arr + hi, arr[m1]) - arr);
+            } else {
+                m2 = mid + ((hi - mid) >> 1);
+                m1 = (int) (std::upper_bound(arr + lo, arr + mid, arr[m2]) - arr);
+            }
+            std::rotate(arr + m1, arr + mid, arr + m2);
+            int split = m1 + (m2 - mid);
+            int l = lo, r = m1, s = split;
+            group.run([this, arr, l, r, s, aux, &group]() {
+                parallelMerge(arr, l, r, s, aux, group);
+            });
+            lo = split;
+            mid = split + (mid - m1);
+        }
+        gallopMerge(arr, lo, mid, hi, aux);
+    }
+
+    //a[0...n)中不大于key的元素个数，从头开始倍增查找再二分
+    static int gallopRight(const T &key, const T *a, const int n) {
+        int lo = 0, hi = 1;
+        while (hi < n && !(key < a[hi - 1])) {
+            lo = hi;
+            hi = 2 * hi + 1;
+        }
+        return (int) (std::upper_bound(a + lo, a + std::min(hi, n), key) - a);
+    }
+
+    //a[0...n)中小于key的元素个数
+    static int gallopLeft(const T &key, const T *a, const int n) {
+        int lo = 0, hi = 1;
+        while (hi < n && a[hi - 1] < key) {
+            lo = hi;
+            hi = 2 * hi + 1;
+        }
+        return (int) (std::lower_bound(a + lo, a + std::min(hi, n), key) - a);
+    }
+
+    void gallopMerge(T *arr, int lo, const int mid, int hi, T *aux) {
+        if (lo >= mid || mid >= hi)
+            return;
+        //左段里不大于右段第一个元素的前缀、右段里不小于左段最后一个元素的后缀都已经在最终位置
+        lo += gallopRight(arr[mid], arr + lo, mid - lo);
+        if (lo == mid)
+            return;
+        hi = mid + gallopLeft(arr[mid - 1], arr + mid, hi - mid);
+
+        std::move(arr + lo, arr + mid, aux + lo);
+        //左段在aux[i...mid)，右段在arr[j...hi)，写入位置k始终不超过j
+        int i = lo, j = mid, k = lo;
+        int minGallop = MIN_GALLOP;
+        int steps = hi - lo <= SIMD_MERGE_LENGTH ? SIMD_MERGE_STEPS - 1 : 0;
+        while (i < mid && j < hi) {
+            //逐个比较，记录一边连续赢的次数
+            int winsLeft = 0, winsRight = 0;
+            while (i < mid && j < hi && winsLeft < minGallop && winsRight < minGallop) {
+                if (arr[j] < aux[i]) {
+                    arr[k++] = std::move(arr[j++]);
+                    winsRight++;
+                    winsLeft = 0;
+                } else {
+                    arr[k++] = std::move(aux[i++]);
+                    winsLeft++;
+                    winsRight = 0;
+                }
+                //很久都没有一边连续赢，数据接近随机，支持SIMD归并的整数类型把剩下的交给排序网络；
+                //短的归并倍增查找也省不了多少，一开始就交给排序网络
+                if (++steps == SIMD_MERGE_STEPS && Network::maxLength() > 0) {
+                    std::move(arr + j, arr + hi, aux + j);
+                    if (Network::merge(aux + i, mid - i, aux + j, hi - j, arr + k))
+                        return;
+                }
+            }
+            //一边连续赢了很多次，说明数据有成段的顺序，改成倍增查找整段搬
+            while (i < mid && j < hi) {
+                int n1 = gallopRight(arr[j], aux + i, mid - i);
+                std::move(aux + i, aux + i + n1, arr + k);
+                i += n1;
+                k += n1;
+                if (i == mid)
+                    break;
+                int n2 = gallopLeft(aux[i], arr + j, hi - j);
+                std::move(arr + j, arr + j + n2, arr + k);
+                j += n2;
+                k += n2;
+                if (j == hi)
+                    break;
+                if (n1 < MIN_GALLOP && n2 < MIN_GALLOP) {
+                    minGallop += 2;
+                    break;
+                }
+                if (minGallop > 1)
+                    minGallop--;
+            }
+        }
+        std::move(aux + i, aux + mid, arr + k);
+    }
+
     void mergeSortRecursive(T *arr, const int lo, const int hi) {
         T *aux = new T[hi - lo + 1];
         mergeSortRecursive(arr, lo, hi, aux);
@@ -53,6 +311,8 @@ private:
     void mergeSortRecursive(T *arr, const int lo, const int hi, T *aux) {
         if (lo >= hi)
             return;
+        if (Network::sort(arr + lo, hi - lo + 1))
+            return;
 
         int mid = ((hi - lo) >> 1) + lo;
         mergeSortRecursive(arr, lo, mid, aux);    //排序前半段
@@ -65,19 +325,21 @@ private:
     void merge2Ways(T *arr, const int lo, const int mid, const int hi, T *aux) {
         //对arr[lo...mid]和arr[mid+1...hi] 归并
         for (int k = lo; k <= hi; k++)
-            aux[k] = arr[k];
+            aux[k] = std::move(arr[k]);
+        if (Network::merge(aux + lo, mid - lo + 1, aux + mid + 1, hi - mid, arr + lo))
+            return;
         int i = lo, j = mid + 1, k = lo;
         while (i <= mid && j <= hi) {
-            //arr[k++] = aux[i] < aux[j] ? aux[i++] : aux[j++];
-            if (aux[i] < aux[j])
-                arr[k++] = aux[i++];
+            //相等时取左边的，保证稳定
+            if (aux[j] < aux[i])
+                arr[k++] = std::move(aux[j++]);
             else
-                arr[k++] = aux[j++];
+                arr[k++] = std::move(aux[i++]);
         }
         while (i <= mid)
-            arr[k++] = aux[i++];
+            arr[k++] = std::move(aux[i++]);
         while (j <= hi)
-            arr[k++] = aux[j++];
+            arr[k++] = std::move(aux[j++]);
     }
 
     void mergeSort3Way(T *arr, int lo, int hi) {
@@ -93,6 +355,8 @@ private:
     void mergeSort3Way(T *arr, int lo, int hi, T *aux) {
         if (lo >= hi)
             return;
+        if (Network::sort(arr + lo, hi - lo + 1))
+            return;
         int mid1 = lo + ((hi - lo) / 3);
         int mid2 = lo + 2 * ((hi - lo) / 3);
         //分成三段
@@ -108,29 +372,29 @@ private:
 
     void merge3Ways(T *arr, int lo, int mid1, int mid2, int hi, T *aux) {
         for (int i = lo; i <= hi; i++)
-            aux[i] = arr[i];
+            aux[i] = std::move(arr[i]);
         int i = lo, j = mid1 + 1, k = mid2 + 1, l = lo;
-        //三个值相互比较
+        //三个值相互比较，相等时取靠左的段，保证稳定
         while ((i <= mid1) && (j <= mid2) && (k <= hi)) {
-            if (aux[i] < aux[j])
-                arr[l++] = (aux[i] < aux[k]) ? aux[i++] : aux[k++];
+            if (!(aux[j] < aux[i]))
+                arr[l++] = std::move(!(aux[k] < aux[i]) ? aux[i++] : aux[k++]);
             else
-                arr[l++] = (aux[j] < aux[k]) ? aux[j++] : aux[k++];
+                arr[l++] = std::move(!(aux[k] < aux[j]) ? aux[j++] : aux[k++]);
         }
         //二个值相互比较
         while ((i <= mid1) && (j <= mid2))
-            arr[l++] = (aux[i] < aux[j]) ? aux[i++] : aux[j++];
+            arr[l++] = std::move(!(aux[j] < aux[i]) ? aux[i++] : aux[j++]);
         while ((j <= mid2) && (k <= hi))
-            arr[l++] = (aux[j] < aux[k]) ? aux[j++] : aux[k++];
+            arr[l++] = std::move(!(aux[k] < aux[j]) ? aux[j++] : aux[k++]);
         while ((i <= mid1) && (k <= hi))
-            arr[l++] = (aux[i] < aux[k]) ? aux[i++] : aux[k++];
+            arr[l++] = std::move(!(aux[k] < aux[i]) ? aux[i++] : aux[k++]);
         //剩余一个直接填充
         while (i <= mid1)
-            arr[l++] = aux[i++];
+            arr[l++] = std::move(aux[i++]);
         while (j <= mid2)
-            arr[l++] = aux[j++];
+            arr[l++] = std::move(aux[j++]);
         while (k <= hi)
-            arr[l++] = aux[k++];
+            arr[l++] = std::move(aux[k++]);
     }
 
     void insertSortAdvanced(T *arr, const int lo, const int hi) {
@@ -141,19 +405,19 @@ private:
     }
 
     inline void insertOperationAdvance(T *arr, int i) {
-        T last = arr[i];    //arr[i]这个值会被覆盖，所以临时保存一份
+        T last = std::move(arr[i]);    //arr[i]这个值会被覆盖，所以临时保存一份
         int j = i - 1;
         while (j >= 0 && last < arr[j]) {
-            arr[j + 1] = arr[j];
+            arr[j + 1] = std::move(arr[j]);
             j--;
         }
-        arr[j + 1] = last;
+        arr[j + 1] = std::move(last);
     }
 
     void swap(T *arr, const int i, const int j) {
-        T k = arr[i];
-        arr[i] = arr[j];
-        arr[j] = k;
+        T k = std::move(arr[i]);
+        arr[i] = std::move(arr[j]);
+        arr[j] = std::move(k);
     }
 
     bool isSorted(T *arr, const int lo, const int hi) {
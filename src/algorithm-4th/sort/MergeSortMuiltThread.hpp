@@ -6,6 +6,8 @@
 #include <queue>
 #include <ctime>
 #include <functional>
+
+#include "LoserTree.hpp"
 using namespace std;
 
 template<typename T>
@@ -22,7 +24,7 @@ public:
     };
 
     void sortAdvanced(T *arr, const int len) {
-        muiltThreadMergeSortTwoThreadMerge(arr, len);
+        muiltThreadMergeSortParallelMerge(arr, len);
     }
 
 public:
@@ -31,16 +33,35 @@ public:
     void muiltThreadMergeSortSingleThreadMerge(T *arr, const int len) {
         auto table = initTable(arr, len);
         muiltThreadMergeSortCore(table);
-        mergeKSortArraySingleThread(table, arr, len);
+        mergeKSortArraySingleThread(table, auxBuffer(len), len);
+        copyBack(arr, len);
     }
 
     void muiltThreadMergeSortTwoThreadMerge(T *arr, const int len) {
         auto table = initTable(arr, len);
         muiltThreadMergeSortCore(table);
-        mergeKSortArrayTwoThread(table, arr, len);
+        mergeKSortArrayTwoThread(table, auxBuffer(len), len);
+        copyBack(arr, len);
+    }
+
+    void muiltThreadMergeSortParallelMerge(T *arr, const int len) {
+        auto table = initTable(arr, len);
+        muiltThreadMergeSortCore(table);
+        mergeKSortArrayParallel(table, auxBuffer(len), len);
+        copyBack(arr, len);
     }
 
-    //存放拆分的数组和该数组的大小
+    //排序过程中额外占用内存的峰值(字节)，主要是归并用的辅助数组
+    size_t peakExtraMemory() const {
+        return peakExtraBytes;
+    }
+
+    //释放辅助数组，下次排序时重新申请
+    void releaseBuffer() {
+        vector<T>().swap(aux);
+    }
+
+    //存放拆分的数组和该数组的大小，每一段都直接指向原数组，不做拷贝
     vector<pair<T *, int>> initTable(T *arr, const int len) {
         vector<pair<T *, int>> table;
         int mod = len % threadNum;
@@ -48,10 +69,8 @@ public:
         int k = 0;
         for (int i = 0; i < threadNum; i++) {
             int t = (i < mod ? 1 : 0);
-            T *tmp = new T[step + t];
-            for (int j = 0; j < (step + t); j++)
-                tmp[j] = arr[k++];
-            table.push_back(make_pair(tmp, step + t));
+            table.push_back(make_pair(arr + k, step + t));
+            k += step + t;
         }
         return table;
     }
@@ -85,23 +104,14 @@ public:
     };
 
 
+    //败者树归并K个有序数组，每输出一个元素只需要log(K)次比较
     void mergeKSortArraySingleThread(const vector<pair<T *, int>> &table, T *arr, int len) {
-        priority_queue<Node, vector<Node>, less<Node> > minHeap;
-
-        for (int i = 0; i < threadNum; i++)
-            minHeap.push(Node(table[i].first, 0, table[i].second));
-
-        int k = 0;
-        int threadHold = len;
-        while (k < threadHold) {
-            Node node = minHeap.top();
-            minHeap.pop();
-            arr[k++] = node.arr[node.index];
-            if (node.index + 1 < node.size) {
-                node.index++;
-                minHeap.push(node);
-            }
-        }
+        vector<RangeSource<T>> sources;
+        for (int i = 0; i < (int) table.size(); i++)
+            sources.push_back(RangeSource<T>(table[i].first, table[i].first + table[i].second));
+        LoserTree<T> loserTree((int) sources.size());
+        loserTree.init(sources.data());
+        loserTree.mergeBatch(sources.data(), arr, len);
     }
 
 
@@ -115,7 +125,8 @@ public:
     void mergeKSortArrayLeftHalf(const vector<pair<T *, int>> &table, T *arr, int len) {
         priority_queue<Node, vector<Node>, less<Node> > minHeap;
         for (int i = 0; i < threadNum; i++) {
-            minHeap.push(Node(table[i].first, 0, table[i].second));
+            if (table[i].second > 0)
+                minHeap.push(Node(table[i].first, 0, table[i].second));
         }
 
         int k = 0;
@@ -137,7 +148,8 @@ public:
         for (int i = 0; i < threadNum; i++) {
             T *arr = table[i].first;
             int size = table[i].second;
-            maxHeap.push(Node(arr, size - 1, size));
+            if (size > 0)
+                maxHeap.push(Node(arr, size - 1, size));
         }
         int k = len - 1;
         int threadHold = len / 2;
@@ -152,7 +164,113 @@ public:
         }
     }
 
+    /*
+     多路归并的并行版本：把输出数组平均切成threadNum段，第p个线程负责输出arr[len*p/threadNum ... len*(p+1)/threadNum)。
+     每个线程先用multiSequenceSelect算出自己那一段在每个有序数组中对应的区间，然后各自归并，线程之间没有任何同步。
+     */
+    void mergeKSortArrayParallel(const vector<pair<T *, int>> &table, T *arr, int len) {
+        vector<thread> t;
+        for (int p = 0; p < threadNum; p++)
+            t.push_back(thread(&MergeSortMuiltThread::mergeKSortArrayPart, this, std::cref(table), arr, len, p));
+        for (int p = 0; p < threadNum; p++)
+            t[p].join();
+    }
+
+    void mergeKSortArrayPart(const vector<pair<T *, int>> &table, T *arr, int len, int p) {
+        int from = (int) ((long long) len * p / threadNum);
+        int to = (int) ((long long) len * (p + 1) / threadNum);
+        if (from >= to)
+            return;
+        vector<int> lower = multiSequenceSelect(table, from);
+        vector<int> upper = multiSequenceSelect(table, to);
+
+        vector<RangeSource<T>> sources;
+        for (int i = 0; i < (int) table.size(); i++)
+            sources.push_back(RangeSource<T>(table[i].first + lower[i], table[i].first + upper[i]));
+        LoserTree<T> loserTree((int) sources.size());
+        loserTree.init(sources.data());
+        loserTree.mergeBatch(sources.data(), arr + from, to - from);
+    }
+
+    /*
+     多序列选择(co-ranking)：在K个有序数组中找到精确的切分点，使得所有数组切分点左边的元素恰好有rank个，
+     并且左边的元素都不大于右边的元素。返回值的第i项是第i个数组中切分点的下标。
+     每个数组维护一个候选区间[lo[i], hi[i])，切分点一定在这个区间内。每一轮取最长的候选区间的中点作为pivot，
+     统计所有数组中小于pivot和不大于pivot的元素个数，就可以把最长的候选区间砍掉一半，
+     所以最多O(K*log(n))轮，每一轮O(K*log(n))次比较。
+     */
+    vector<int> multiSequenceSelect(const vector<pair<T *, int>> &table, int rank) {
+        int k = (int) table.size();
+        vector<int> lo(k, 0), hi(k), lt(k), le(k);
+        for (int i = 0; i < k; i++)
+            hi[i] = table[i].second;
+        while (true) {
+            //找到最长的候选区间
+            int longest = -1;
+            for (int i = 0; i < k; i++)
+                if (lo[i] < hi[i] && (longest < 0 || hi[i] - lo[i] > hi[longest] - lo[longest]))
+                    longest = i;
+            //所有候选区间都为空，切分点已经确定
+            if (longest < 0)
+                return lo;
+
+            T pivot = table[longest].first[lo[longest] + ((hi[longest] - lo[longest]) >> 1)];
+            int lessCount = 0, leqCount = 0;
+            for (int i = 0; i < k; i++) {
+                T *a = table[i].first;
+                lt[i] = (int) (lower_bound(a + lo[i], a + hi[i], pivot) - a);
+                le[i] = (int) (upper_bound(a + lt[i], a + hi[i], pivot) - a);
+                lessCount += lt[i];
+                leqCount += le[i];
+            }
+
+            if (rank < lessCount) {
+                //切分点全部在pivot左边
+                for (int i = 0; i < k; i++)
+                    hi[i] = lt[i];
+            } else if (rank > leqCount) {
+                //切分点全部在pivot右边
+                for (int i = 0; i < k; i++)
+                    lo[i] = le[i];
+            } else {
+                //小于pivot的全部放左边，等于pivot的按数组顺序补足rank个
+                int need = rank - lessCount;
+                for (int i = 0; i < k; i++) {
+                    int take = min(need, le[i] - lt[i]);
+                    lo[i] = lt[i] + take;
+                    need -= take;
+                }
+                return lo;
+            }
+        }
+    }
+
 private:
+    //归并的输出先写到aux里，多次排序复用同一块内存
+    vector<T> aux;
+    size_t peakExtraBytes = 0;
+
+    T *auxBuffer(const int len) {
+        if ((int) aux.size() < len)
+            aux.resize(len);
+        size_t bytes = aux.capacity() * sizeof(T) + threadNum * sizeof(pair<T *, int>);
+        if (bytes > peakExtraBytes)
+            peakExtraBytes = bytes;
+        return aux.data();
+    }
+
+    //多线程把aux中归并好的结果拷回原数组
+    void copyBack(T *arr, const int len) {
+        vector<thread> t;
+        for (int p = 0; p < threadNum; p++) {
+            int from = (int) ((long long) len * p / threadNum);
+            int to = (int) ((long long) len * (p + 1) / threadNum);
+            t.push_back(thread([this, arr, from, to]() { std::copy(aux.begin() + from, aux.begin() + to, arr + from); }));
+        }
+        for (int p = 0; p < threadNum; p++)
+            t[p].join();
+    }
+
     void mergeSortSingleThread(T *arr, const int len) {
         std::sort(arr, arr+len);
     }
@@ -0,0 +1,340 @@
+#ifndef PARTITION_HPP
+#define PARTITION_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "SortingNetwork.hpp"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace partition_simd {
+
+    //没有向量实现的类型和比较函数
+    template<typename T, typename Compare, typename Enable = void>
+    struct Dispatch {
+        static bool partition(T *, const int, const T &, int &) { return false; }
+    };
+
+#if SORTING_NETWORK_X86
+
+#define PARTITION_TARGET_AVX2 __attribute__((target("avx2")))
+
+    /*
+     置换表：掩码的第i位为1表示第i个元素属于右边，
+     table[mask]把属于左边的元素按原来的顺序排到前面，属于右边的排到后面
+     */
+    template<int W>
+    struct PermutationTable {
+        unsigned char index[1 << W][8];
+
+        PermutationTable() {
+            const int scale = 8 / W;    //64位元素占两个32位的位置
+            for (int mask = 0; mask < (1 << W); mask++) {
+                int pos = 0;
+                for (int pass = 0; pass < 2; pass++)
+                    for (int i = 0; i < W; i++)
+                        if (((mask >> i) & 1) == pass) {
+                            for (int s = 0; s < scale; s++)
+                                index[mask][pos * scale + s] = (unsigned char) (i * scale + s);
+                            pos++;
+                        }
+            }
+        }
+
+        static const PermutationTable &instance() {
+            static PermutationTable table;
+            return table;
+        }
+    };
+
+    struct Avx2Int32 {
+        typedef int Elem;
+        typedef __m256i Vec;
+        static const int W = 8;
+
+        PARTITION_TARGET_AVX2 static Vec load(const int *p) { return _mm256_loadu_si256((const __m256i *) p); }
+
+        PARTITION_TARGET_AVX2 static void store(int *p, Vec v) { _mm256_storeu_si256((__m256i *) p, v); }
+
+        PARTITION_TARGET_AVX2 static Vec set1(int x) { return _mm256_set1_epi32(x); }
+
+        //equalLeft时 > pivot 的去右边，否则 >= pivot 的去右边
+        PARTITION_TARGET_AVX2 static int rightMask(Vec v, Vec pv, bool equalLeft) {
+            if (equalLeft)
+                return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, pv)));
+            return ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pv, v))) & 0xFF;
+        }
+
+        PARTITION_TARGET_AVX2 static Vec compress(Vec v, int mask) {
+            __m128i idx = _mm_loadl_epi64((const __m128i *) PermutationTable<W>::instance().index[mask]);
+            return _mm256_permutevar8x32_epi32(v, _mm256_cvtepu8_epi32(idx));
+        }
+    };
+
+    struct Avx2Float {
+        typedef float Elem;
+        typedef __m256 Vec;
+        static const int W = 8;
+
+        PARTITION_TARGET_AVX2 static Vec load(const float *p) { return _mm256_loadu_ps(p); }
+
+        PARTITION_TARGET_AVX2 static void store(float *p, Vec v) { _mm256_storeu_ps(p, v); }
+
+        PARTITION_TARGET_AVX2 static Vec set1(float x) { return _mm256_set1_ps(x); }
+
+        PARTITION_TARGET_AVX2 static int rightMask(Vec v, Vec pv, bool equalLeft) {
+            return _mm256_movemask_ps(equalLeft ? _mm256_cmp_ps(v, pv, _CMP_GT_OQ) : _mm256_cmp_ps(v, pv, _CMP_GE_OQ));
+        }
+
+        PARTITION_TARGET_AVX2 static Vec compress(Vec v, int mask) {
+            __m128i idx = _mm_loadl_epi64((const __m128i *) PermutationTable<W>::instance().index[mask]);
+            return _mm256_permutevar8x32_ps(v, _mm256_cvtepu8_epi32(idx));
+        }
+    };
+
+    struct Avx2Int64 {
+        typedef int64_t Elem;
+        typedef __m256i Vec;
+        static const int W = 4;
+
+        PARTITION_TARGET_AVX2 static Vec load(const int64_t *p) { return _mm256_loadu_si256((const __m256i *) p); }
+
+        PARTITION_TARGET_AVX2 static void store(int64_t *p, Vec v) { _mm256_storeu_si256((__m256i *) p, v); }
+
+        PARTITION_TARGET_AVX2 static Vec set1(int64_t x) { return _mm256_set1_epi64x(x); }
+
+        PARTITION_TARGET_AVX2 static int rightMask(Vec v, Vec pv, bool equalLeft) {
+            if (equalLeft)
+                return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, pv)));
+            return ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(pv, v))) & 0xF;
+        }
+
+        PARTITION_TARGET_AVX2 static Vec compress(Vec v, int mask) {
+            __m128i idx = _mm_loadl_epi64((const __m128i *) PermutationTable<W>::instance().index[mask]);
+            return _mm256_permutevar8x32_epi32(v, _mm256_cvtepu8_epi32(idx));
+        }
+    };
+
+    struct Avx2Double {
+        typedef double Elem;
+        typedef __m256d Vec;
+        static const int W = 4;
+
+        PARTITION_TARGET_AVX2 static Vec load(const double *p) { return _mm256_loadu_pd(p); }
+
+        PARTITION_TARGET_AVX2 static void store(double *p, Vec v) { _mm256_storeu_pd(p, v); }
+
+        PARTITION_TARGET_AVX2 static Vec set1(double x) { return _mm256_set1_pd(x); }
+
+        PARTITION_TARGET_AVX2 static int rightMask(Vec v, Vec pv, bool equalLeft) {
+            return _mm256_movemask_pd(equalLeft ? _mm256_cmp_pd(v, pv, _CMP_GT_OQ) : _mm256_cmp_pd(v, pv, _CMP_GE_OQ));
+        }
+
+        PARTITION_TARGET_AVX2 static Vec compress(Vec v, int mask) {
+            __m128i idx = _mm_loadl_epi64((const __m128i *) PermutationTable<W>::instance().index[mask]);
+            __m256i perm = _mm256_cvtepu8_epi32(idx);
+            return _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(v), perm));
+        }
+    };
+
+    /*
+     原地的向量化partition
+     先把两端各一个向量读到寄存器里，两端就各空出了W个位置。之后每次从空位较少的那一端读一个向量，
+     压缩后整个向量分别写到左写指针和右写指针处(两边的空位都不少于W，不会覆盖没读过的数据)。
+     最后剩下的不足一个向量的元素和开头存下的两个向量逐个放到中间。
+     */
+    template<typename Ops>
+    int partitionKernel(typename Ops::Elem *arr, const int n, const typename Ops::Elem pivot) {
+        typedef typename Ops::Elem E;
+        typedef typename Ops::Vec V;
+        const int W = Ops::W;
+        V pv = Ops::set1(pivot);
+        E saved[2 * W];
+        Ops::store(saved, Ops::load(arr));
+        Ops::store(saved + W, Ops::load(arr + n - W));
+
+        int l = W, r = n - W;    //[l, r)还没有读
+        int wl = 0, wr = n;      //左边部分写到[0, wl)，右边部分写到[wr, n)
+        bool equalLeft = false;
+        while (r - l >= W) {
+            V v;
+            bool fromLeft = l - wl <= wr - r;
+            if (fromLeft) {
+                v = Ops::load(arr + l);
+                l += W;
+            } else {
+                r -= W;
+                v = Ops::load(arr + r);
+            }
+            //和pivot相等的元素一个向量放左边、下一个向量放右边，大量重复元素时两边也是均衡的
+            equalLeft = !equalLeft;
+            int mask = Ops::rightMask(v, pv, equalLeft);
+            int right = __builtin_popcount(mask);
+            V c = Ops::compress(v, mask);
+            Ops::store(arr + wl, c);
+            Ops::store(arr + wr - W, c);
+            wl += W - right;
+            wr -= right;
+        }
+
+        //剩下的元素也先存起来，[wl, wr)整段都是空位
+        E rest[W];
+        int m = r - l;
+        for (int i = 0; i < m; i++)
+            rest[i] = arr[l + i];
+        for (int i = 0; i < m; i++) {
+            bool left = (i & 1) ? !(pivot < rest[i]) : rest[i] < pivot;
+            if (left)
+                arr[wl++] = rest[i];
+            else
+                arr[--wr] = rest[i];
+        }
+        for (int i = 0; i < 2 * W; i++) {
+            bool left = (i & 1) ? !(pivot < saved[i]) : saved[i] < pivot;
+            if (left)
+                arr[wl++] = saved[i];
+            else
+                arr[--wr] = saved[i];
+        }
+        return wl;
+    }
+
+    template<typename Ops>
+    PARTITION_TARGET_AVX2 __attribute__((flatten))
+    int partitionAvx2(typename Ops::Elem *arr, const int n, const typename Ops::Elem pivot) {
+        return partitionKernel<Ops>(arr, n, pivot);
+    }
+
+#undef PARTITION_TARGET_AVX2
+
+    template<typename T>
+    struct Avx2OpsOf {
+        typedef void type;
+    };
+
+    template<>
+    struct Avx2OpsOf<int> {
+        typedef Avx2Int32 type;
+    };
+
+    template<>
+    struct Avx2OpsOf<float> {
+        typedef Avx2Float type;
+    };
+
+    template<>
+    struct Avx2OpsOf<int64_t> {
+        typedef Avx2Int64 type;
+    };
+
+    template<>
+    struct Avx2OpsOf<double> {
+        typedef Avx2Double type;
+    };
+
+    template<typename T>
+    struct Dispatch<T, std::less<T>, typename std::enable_if<!std::is_void<typename Avx2OpsOf<T>::type>::value>::type> {
+        typedef typename Avx2OpsOf<T>::type Ops;
+
+        static bool partition(T *arr, const int n, const T &pivot, int &k) {
+            //太短的区间向量化的收益抵不过收尾的开销
+            if (n < 8 * Ops::W || sortingNetworkIsa() < SORTING_NETWORK_AVX2)
+                return false;
+            k = partitionAvx2<Ops>(arr, n, pivot);
+            return true;
+        }
+    };
+
+#endif //SORTING_NETWORK_X86
+}
+
+#pragma GCC diagnostic pop
+
+/*
+ 快速排序的partition
+ Hoare的partition每一步都要根据比较结果决定是否继续扫描，随机数据上大约一半的分支预测会失败。
+   - 分块无分支(BlockQuicksort)：左右两端各取一个块，先只做比较，把需要交换的元素的偏移记到数组里
+     (num += 比较结果，没有分支)，再按偏移成对交换；
+   - AVX2压缩存储：int/float/int64_t/double用std::less比较时，一次比较一个向量，得到的掩码查表得到一个置换，
+     把属于左边的元素挤到向量前面、属于右边的挤到后面，整个向量分别写到左右两个写指针处。
+ 和pivot相等的元素两边都可以放，大量重复元素时两边仍然均衡。
+ */
+template<typename T, typename Compare = std::less<T> >
+class Partition {
+public:
+    /*
+     arr[lo]是pivot，把arr[lo+1...hi]分成 <=pivot 和 >=pivot 两部分，再把pivot放到中间
+     返回pivot最终的位置p：arr[lo...p-1] <= arr[p] <= arr[p+1...hi]
+     */
+    static int partition(T *arr, const int lo, const int hi, Compare comp = Compare()) {
+        int p = lo + partitionRange(arr + lo + 1, hi - lo, arr[lo], comp);
+        std::iter_swap(arr + lo, arr + p);
+        return p;
+    }
+
+    //把arr[0, n)按pivot分成两部分，返回左边部分的长度k：arr[0, k) <= pivot <= arr[k, n)
+    static int partitionRange(T *arr, const int n, const T &pivot, Compare comp = Compare()) {
+        int k;
+        if (partition_simd::Dispatch<T, Compare>::partition(arr, n, pivot, k))
+            return k;
+        return blockPartition(arr, n, pivot, comp);
+    }
+
+private:
+    static const int BLOCK_SIZE = 64;
+
+    static int blockPartition(T *arr, const int n, const T pivot, Compare comp) {
+        //[0, l)都 <= pivot，(r, n)都 >= pivot，[l, r]未知
+        int l = 0, r = n - 1;
+        unsigned char offsetsL[BLOCK_SIZE], offsetsR[BLOCK_SIZE];
+        int numL = 0, numR = 0, startL = 0, startR = 0;
+        while (r - l + 1 >= 2 * BLOCK_SIZE) {
+            if (numL == 0) {
+                startL = 0;
+                for (int i = 0; i < BLOCK_SIZE; i++) {
+                    offsetsL[numL] = (unsigned char) i;
+                    numL += !comp(arr[l + i], pivot);
+                }
+            }
+            if (numR == 0) {
+                startR = 0;
+                for (int i = 0; i < BLOCK_SIZE; i++) {
+                    offsetsR[numR] = (unsigned char) i;
+                    numR += !comp(pivot, arr[r - i]);
+                }
+            }
+            int num = std::min(numL, numR);
+            for (int i = 0; i < num; i++)
+                std::iter_swap(arr + l + offsetsL[startL + i], arr + r - offsetsR[startR + i]);
+            numL -= num;
+            numR -= num;
+            startL += num;
+            startR += num;
+            //一个块里需要交换的元素都换完了，整个块就处理好了
+            if (numL == 0)
+                l += BLOCK_SIZE;
+            if (numR == 0)
+                r -= BLOCK_SIZE;
+        }
+
+        //剩下不到两个块(包括还没换完的那个块)用Hoare的方法处理
+        int i = l, j = r;
+        while (true) {
+            while (i <= j && comp(arr[i], pivot)) i++;
+            while (i <= j && comp(pivot, arr[j])) j--;
+            if (i >= j)
+                break;
+            std::iter_swap(arr + i, arr + j);
+            i++;
+            j--;
+        }
+        return i;
+    }
+};
+
+#endif //PARTITION_HPP
@@ -0,0 +1,237 @@
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+#ifdef __linux__
+
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#endif
+
+/*
+ 硬件性能计数器，基于Linux的perf_event_open
+   - 统计cycles、instructions、branch-misses、L1数据缓存读缺失、LLC缺失；
+   - start()为要统计的线程打开计数器并清零开始计数，stop()停止计数并返回各项的累加值；
+   - allThreads为true时统计进程里的所有线程(打开时已有的线程，加上计数期间新建的线程)，
+     这样线程池里的工作线程也算在内；为false时只统计调用start()的线程；
+   - 计数器是可选的：不是Linux、内核不支持某个事件、或者没有权限(perf_event_paranoid太高、容器里禁用)时，
+     打不开的那一项是-1，不影响程序运行；
+   - 只统计用户态(exclude_kernel)，perf_event_paranoid<=2时普通用户就能用；
+   - 事件比硬件计数器多时内核会分时复用，按enabled/running的时间比例换算。
+ */
+enum PerfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_EVENT_COUNT
+};
+
+inline const char *perfEventName(const int event) {
+    switch (event) {
+        case PERF_CYCLES:
+            return "cycles";
+        case PERF_INSTRUCTIONS:
+            return "instructions";
+        case PERF_BRANCH_MISSES:
+            return "branch_misses";
+        case PERF_L1D_MISSES:
+            return "l1d_misses";
+        case PERF_LLC_MISSES:
+            return "llc_misses";
+    }
+    return "unknown";
+}
+
+//一次计数的结果，没有统计到的项是-1
+struct PerfSample {
+    long long counts[PERF_EVENT_COUNT];
+
+    PerfSample() {
+        for (int i = 0; i < PERF_EVENT_COUNT; i++)
+            counts[i] = -1;
+    }
+
+    long long operator[](const int event) const { return counts[event]; }
+
+    bool valid() const {
+        for (int i = 0; i < PERF_EVENT_COUNT; i++)
+            if (counts[i] >= 0)
+                return true;
+        return false;
+    }
+
+    //每个周期执行的指令数，统计不到时是-1
+    double ipc() const {
+        if (counts[PERF_CYCLES] <= 0 || counts[PERF_INSTRUCTIONS] < 0)
+            return -1;
+        return (double) counts[PERF_INSTRUCTIONS] / counts[PERF_CYCLES];
+    }
+
+    //逐项累加，只要有一边是-1就以另一边为准
+    PerfSample &operator+=(const PerfSample &that) {
+        for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+            if (that.counts[i] < 0)
+                continue;
+            counts[i] = (counts[i] < 0 ? 0 : counts[i]) + that.counts[i];
+        }
+        return *this;
+    }
+
+    //逐项除以n，用来求平均
+    PerfSample operator/(const long long n) const {
+        PerfSample avg;
+        for (int i = 0; i < PERF_EVENT_COUNT; i++)
+            avg.counts[i] = counts[i] < 0 || n <= 0 ? counts[i] : counts[i] / n;
+        return avg;
+    }
+};
+
+class PerfCounters {
+public:
+    explicit PerfCounters(bool allThreads = true) : allThreads(allThreads) {}
+
+    ~PerfCounters() {
+        closeAll();
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    //打开计数器并开始计数，一个都打不开时返回false
+    bool start() {
+        closeAll();
+#ifdef __linux__
+        std::vector<pid_t> tids;
+        if (allThreads)
+            tids = threadIds();
+        if (tids.empty())
+            tids.push_back(0);  //0表示调用者所在的线程
+        for (pid_t tid : tids) {
+            for (int event = 0; event < PERF_EVENT_COUNT; event++) {
+                int fd = openCounter(event, tid);
+                if (fd >= 0)
+                    counters.push_back(Counter{event, fd});
+            }
+        }
+        for (const Counter &c : counters)
+            ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+        for (const Counter &c : counters)
+            ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+        return !counters.empty();
+    }
+
+    //停止计数，返回start()以来的累加值并关闭计数器
+    PerfSample stop() {
+        PerfSample sample;
+#ifdef __linux__
+        for (const Counter &c : counters)
+            ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+        for (const Counter &c : counters) {
+            uint64_t values[3];  //value, time_enabled, time_running
+            if (read(c.fd, values, sizeof(values)) != (ssize_t) sizeof(values))
+                continue;
+            long long count = (long long) values[0];
+            if (values[2] > 0 && values[2] < values[1])
+                count = (long long) ((double) values[0] * values[1] / values[2]);
+            sample.counts[c.event] = (sample.counts[c.event] < 0 ? 0 : sample.counts[c.event]) + count;
+        }
+#endif
+        closeAll();
+        return sample;
+    }
+
+    //当前环境能不能打开至少一个计数器
+    static bool supported() {
+        PerfCounters probe(false);
+        bool ok = probe.start();
+        probe.stop();
+        return ok;
+    }
+
+private:
+    struct Counter {
+        int event;
+        int fd;
+    };
+
+    bool allThreads;
+    std::vector<Counter> counters;
+
+    void closeAll() {
+#ifdef __linux__
+        for (const Counter &c : counters)
+            close(c.fd);
+#endif
+        counters.clear();
+    }
+
+#ifdef __linux__
+
+    //失败时返回-1
+    static int openCounter(const int event, const pid_t tid) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        switch (event) {
+            case PERF_CYCLES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case PERF_INSTRUCTIONS:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case PERF_BRANCH_MISSES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case PERF_L1D_MISSES:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                              | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            default:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+        }
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return (int) syscall(__NR_perf_event_open, &attr, tid, -1, -1, 0);
+    }
+
+    //进程里所有线程的id
+    static std::vector<pid_t> threadIds() {
+        std::vector<pid_t> tids;
+        DIR *dir = opendir("/proc/self/task");
+        if (dir == nullptr)
+            return tids;
+        dirent *entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (entry->d_name[0] >= '0' && entry->d_name[0] <= '9')
+                tids.push_back((pid_t) atoi(entry->d_name));
+        }
+        closedir(dir);
+        return tids;
+    }
+
+#endif
+};
+
+
+#endif //PERFCOUNTERS_HPP
@@ -5,7 +5,15 @@
 #ifndef QUICKSORT_HPP
 #define QUICKSORT_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
+#include "HeapSort.hpp"
+#include "Partition.hpp"
+#include "SortingNetwork.hpp"
 
 template<typename T>
 class QuickSort {
@@ -19,9 +27,9 @@ public:
         quickSortRecursive(arr, len);
     }
 
-    //三路归并排序
+    //pdqsort: 内省排序 + 分块无分支partition + 有序模式识别
     void sortAdvanced(T *arr, const int len) {
-        quickSort3Ways(arr, len);
+        pdqSort(arr, len);
     }
 
 public:
@@ -40,6 +48,18 @@ public:
         // assert(isSorted(arr, len));
     }
 
+    void pdqSort(T *arr, const int len) {
+        if (len <= 1)
+            return;
+        //坏的partition最多允许log2(n)次，再多就换成堆排序，保证O(nlogn)
+        int badAllowed = 0;
+        for (int n = len; n > 1; n >>= 1)
+            badAllowed++;
+        networkLength = SortingNetwork<T>::maxLength();
+        pdqSortLoop(arr, arr + len, badAllowed, true);
+        // assert(isSorted(arr, len));
+    }
+
 
 public:
     void quickSortIterative(T *arr, int lo, int hi) {
@@ -79,7 +99,9 @@ public:
     int QUICK2INSERT_THREAD = 24;
 
     void quickSortRecursive(T *arr, int lo, int hi) {
-        //base case
+        //base case，int/float/int64_t/double的小区间交给SIMD排序网络
+        if (lo < hi && SortingNetwork<T>::sort(arr + lo, hi - lo + 1))
+            return;
         if (hi - lo <= QUICK2INSERT_THREAD) {
             if (QUICK2INSERT_THREAD > 0)
                 insertSortAdvanced(arr, lo, hi);
@@ -95,6 +117,8 @@ public:
     }
 
     void quickSort3Ways(T *arr, int lo, int hi) {
+        if (lo < hi && SortingNetwork<T>::sort(arr + lo, hi - lo + 1))
+            return;
         if (hi - lo <= 16) {
             insertSortAdvanced(arr, lo, hi);
             return;
@@ -134,21 +158,8 @@ public:
     int partitionAdvance(T *arr, int lo, int hi) {
         int randIndex = rand() % (hi - lo + 1) + lo;
         swap(arr, lo, randIndex);
-        T pivot = arr[lo];
-        int i = lo + 1, j = hi;
-        while (true) {
-            while (i <= hi && arr[i] <= pivot) i++;
-            while (j >= lo + 1 && arr[j] >= pivot) j--;
-            if (i >= j)
-                break;
-            swap(arr, i, j);
-        }
-        /* 最后退出时arr[i] >= pivot，arr[j] =< pivot，
-        我们应该将小于pivot的数交换到第一个元素的位置，也就是
-        交换arr[j]和arr[lo]
-        */
-        swap(arr, lo, j);
-        return j;
+        //arr[lo...p-1] <= arr[p] <= arr[p+1...hi]
+        return Partition<T>::partition(arr, lo, hi);
     }
 
     int partitionBase(T *arr, int lo, int hi) {
@@ -168,6 +179,235 @@ public:
         return j;
     }
 
+    /*
+     pattern-defeating quicksort
+     1. 小区间用插入排序，不是最左边的区间可以用无哨兵的插入排序(左边的元素都不大于它们)；
+     2. pivot大区间取九数中值(ninther)，小区间取三数中值；
+     3. pivot和左边界外的元素相等，说明这一段全是>=pivot的元素，先用partitionLeft把等于pivot的元素
+        都挪到左边一次排除掉，大量重复元素时是线性的；
+     4. 基本类型用Partition里分块无分支或向量化的partition，不产生分支预测失败；
+     5. partition很不均衡时打乱几个元素破坏输入的模式，连续log2(n)次不均衡就换成堆排序；
+     6. partition时一个元素都没交换，说明这一段可能已经有序，试着用有限步数的插入排序直接排完，
+        升序、降序(第一次partition后变成升序)、基本有序的输入都是线性的。
+     */
+    static const int PDQ_INSERTION_SORT_THRESHOLD = 24;
+    static const int PDQ_NINTHER_THRESHOLD = 128;
+    static const int PDQ_PARTIAL_INSERTION_SORT_LIMIT = 8;
+
+    //不超过这个长度的区间用SIMD排序网络，0表示T没有向量实现
+    int networkLength = 0;
+
+    void pdqSortLoop(T *begin, T *end, int badAllowed, bool leftmost) {
+        while (true) {
+            ptrdiff_t size = end - begin;
+            if (size <= networkLength && SortingNetwork<T>::sort(begin, (int) size))
+                return;
+            if (size < PDQ_INSERTION_SORT_THRESHOLD) {
+                if (leftmost)
+                    insertionSort(begin, end);
+                else
+                    unguardedInsertionSort(begin, end);
+                return;
+            }
+
+            //选出的pivot放在begin上
+            ptrdiff_t s2 = size / 2;
+            if (size > PDQ_NINTHER_THRESHOLD) {
+                sort3(begin, begin + s2, end - 1);
+                sort3(begin + 1, begin + (s2 - 1), end - 2);
+                sort3(begin + 2, begin + (s2 + 1), end - 3);
+                sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1));
+                std::iter_swap(begin, begin + s2);
+            } else {
+                sort3(begin + s2, begin, end - 1);
+            }
+
+            if (!leftmost && !(*(begin - 1) < *begin)) {
+                begin = partitionLeft(begin, end) + 1;
+                continue;
+            }
+
+            bool alreadyPartitioned;
+            T *pivotPos = std::is_arithmetic<T>::value ? partitionRightBranchless(begin, end, alreadyPartitioned)
+                                                       : partitionRight(begin, end, alreadyPartitioned);
+
+            ptrdiff_t lSize = pivotPos - begin;
+            ptrdiff_t rSize = end - (pivotPos + 1);
+            bool highlyUnbalanced = lSize < size / 8 || rSize < size / 8;
+            if (highlyUnbalanced) {
+                if (--badAllowed == 0) {
+                    HeapSort<T>().sortAdvanced(begin, (int) size);
+                    return;
+                }
+                if (lSize >= PDQ_INSERTION_SORT_THRESHOLD) {
+                    std::iter_swap(begin, begin + lSize / 4);
+                    std::iter_swap(pivotPos - 1, pivotPos - lSize / 4);
+                    if (lSize > PDQ_NINTHER_THRESHOLD) {
+                        std::iter_swap(begin + 1, begin + (lSize / 4 + 1));
+                        std::iter_swap(begin + 2, begin + (lSize / 4 + 2));
+                        std::iter_swap(pivotPos - 2, pivotPos - (lSize / 4 + 1));
+                        std::iter_swap(pivotPos - 3, pivotPos - (lSize / 4 + 2));
+                    }
+                }
+                if (rSize >= PDQ_INSERTION_SORT_THRESHOLD) {
+                    std::iter_swap(pivotPos + 1, pivotPos + (1 + rSize / 4));
+                    std::iter_swap(end - 1, end - rSize / 4);
+                    if (rSize > PDQ_NINTHER_THRESHOLD) {
+                        std::iter_swap(pivotPos + 2, pivotPos + (2 + rSize / 4));
+                        std::iter_swap(pivotPos + 3, pivotPos + (3 + rSize / 4));
+                        std::iter_swap(end - 2, end - (1 + rSize / 4));
+                        std::iter_swap(end - 3, end - (2 + rSize / 4));
+                    }
+                }
+            } else if (alreadyPartitioned && partialInsertionSort(begin, pivotPos)
+                       && partialInsertionSort(pivotPos + 1, end)) {
+                return;
+            }
+
+            //左半部分递归，右半部分循环
+            pdqSortLoop(begin, pivotPos, badAllowed, leftmost);
+            begin = pivotPos + 1;
+            leftmost = false;
+        }
+    }
+
+    static void sort2(T *a, T *b) {
+        if (*b < *a)
+            std::iter_swap(a, b);
+    }
+
+    static void sort3(T *a, T *b, T *c) {
+        sort2(a, b);
+        sort2(b, c);
+        sort2(a, b);
+    }
+
+    static void insertionSort(T *begin, T *end) {
+        if (begin == end)
+            return;
+        for (T *cur = begin + 1; cur != end; ++cur) {
+            T *sift = cur;
+            T *sift1 = cur - 1;
+            if (*sift < *sift1) {
+                T tmp = std::move(*sift);
+                do {
+                    *sift-- = std::move(*sift1);
+                } while (sift != begin && tmp < *--sift1);
+                *sift = std::move(tmp);
+            }
+        }
+    }
+
+    //begin左边的元素不大于区间内任何元素，它就是哨兵，不用检查越界
+    static void unguardedInsertionSort(T *begin, T *end) {
+        if (begin == end)
+            return;
+        for (T *cur = begin + 1; cur != end; ++cur) {
+            T *sift = cur;
+            T *sift1 = cur - 1;
+            if (*sift < *sift1) {
+                T tmp = std::move(*sift);
+                do {
+                    *sift-- = std::move(*sift1);
+                } while (tmp < *--sift1);
+                *sift = std::move(tmp);
+            }
+        }
+    }
+
+    //移动次数超过上限就放弃，返回false；否则排好序返回true
+    static bool partialInsertionSort(T *begin, T *end) {
+        if (begin == end)
+            return true;
+        ptrdiff_t limit = 0;
+        for (T *cur = begin + 1; cur != end; ++cur) {
+            T *sift = cur;
+            T *sift1 = cur - 1;
+            if (*sift < *sift1) {
+                T tmp = std::move(*sift);
+                do {
+                    *sift-- = std::move(*sift1);
+                } while (sift != begin && tmp < *--sift1);
+                *sift = std::move(tmp);
+                limit += cur - sift;
+            }
+            if (limit > PDQ_PARTIAL_INSERTION_SORT_LIMIT)
+                return false;
+        }
+        return true;
+    }
+
+    //[begin, end)分成 < pivot 和 >= pivot 两部分，返回pivot最终的位置
+    static T *partitionRight(T *begin, T *end, bool &alreadyPartitioned) {
+        T pivot = std::move(*begin);
+        T *first = begin;
+        T *last = end;
+        //三数取中保证了右边有不小于pivot的元素，左边有不大于pivot的元素，内层循环不用检查越界
+        while (*++first < pivot);
+        if (first - 1 == begin)
+            while (first < last && !(*--last < pivot));
+        else
+            while (!(*--last < pivot));
+
+        alreadyPartitioned = first >= last;
+        while (first < last) {
+            std::iter_swap(first, last);
+            while (*++first < pivot);
+            while (!(*--last < pivot));
+        }
+
+        T *pivotPos = first - 1;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return pivotPos;
+    }
+
+    //中间未知的部分交给Partition：分块无分支，int/float/int64_t/double在AVX2上用向量化的partition
+    static T *partitionRightBranchless(T *begin, T *end, bool &alreadyPartitioned) {
+        T pivot = std::move(*begin);
+        T *first = begin;
+        T *last = end;
+        while (*++first < pivot);
+        if (first - 1 == begin)
+            while (first < last && !(*--last < pivot));
+        else
+            while (!(*--last < pivot));
+
+        alreadyPartitioned = first >= last;
+        if (!alreadyPartitioned) {
+            std::iter_swap(first, last);
+            ++first;
+            first += Partition<T>::partitionRange(first, (int) (last - first), pivot);
+        }
+
+        T *pivotPos = first - 1;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return pivotPos;
+    }
+
+    //把和pivot相等的元素都放到左边：[begin, pivotPos] <= pivot < (pivotPos, end)
+    static T *partitionLeft(T *begin, T *end) {
+        T pivot = std::move(*begin);
+        T *first = begin;
+        T *last = end;
+        while (pivot < *--last);
+        if (last + 1 == end)
+            while (first < last && !(pivot < *++first));
+        else
+            while (!(pivot < *++first));
+
+        while (first < last) {
+            std::iter_swap(first, last);
+            while (pivot < *--last);
+            while (!(pivot < *++first));
+        }
+
+        T *pivotPos = last;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return pivotPos;
+    }
 
     void insertSortAdvanced(T *arr, const int lo, const int hi) {
         for (int i = lo + 1; i <= hi; i++) {
@@ -176,19 +416,19 @@ public:
     }
 
     inline void insertOperationAdvance(T *arr, int i) {
-        T last = arr[i];    //arr[i]这个值会被覆盖，所以临时保存一份
+        T last = std::move(arr[i]);    //arr[i]这个值会被覆盖，所以临时保存一份
         int j = i - 1;
         while (j >= 0 && last < arr[j]) {
-            arr[j + 1] = arr[j];
+            arr[j + 1] = std::move(arr[j]);
             j--;
         }
-        arr[j + 1] = last;
+        arr[j + 1] = std::move(last);
     }
 
     void swap(T *arr, const int i, const int j) {
-        T k = arr[i];
-        arr[i] = arr[j];
-        arr[j] = k;
+        T k = std::move(arr[i]);
+        arr[i] = std::move(arr[j]);
+        arr[j] = std::move(k);
     }
 
     bool isSorted(T *arr, const int lo, const int hi) {
@@ -6,98 +6,113 @@
 #define QUICKSORTMUILTTHREAD_HPP
 
 #include <algorithm>
-#include <functional> 
+#include <functional>
 #include <thread>
 
-template<typename T>
+#include "Partition.hpp"
+#include "WorkStealingPool.hpp"
+
+/*
+ 任务并行的快速排序
+ 每次partition之后，把较小的一半作为子任务交给工作窃取线程池，当前线程继续处理较大的一半，
+ 一直拆到grainSize以下再交给串行排序。空闲的线程会去偷别人拆出来的子任务，所有核都能用上。
+ */
+template<typename T, typename Compare = std::less<T> >
 class QuickSortMuiltThread {
 public:
+    explicit QuickSortMuiltThread(Compare comp = Compare()) : comp(comp) {}
 
     void sortIterative(T *arr, const int len) {
-        twoThreadQuickSort(arr, len);
+        parallelQuickSort(arr, len);
     };
 
     void sortRecursive(T *arr, const int len) {
-        twoThreadQuickSort(arr, len);
+        parallelQuickSort(arr, len);
     };
 
     void sortAdvanced(T *arr, const int len) {
-        fourThreadQuickSort(arr, len);
+        parallelQuickSort(arr, len);
     }
 
-private:
-    void twoThreadQuickSort(T *arr, const int len) {
-        twoThreadQuickSort(arr, 0, len - 1);
-    }
+public:
+    //小于这个长度的区间不再拆分，0表示根据数组长度和线程数自动选择
+    int grainSize = 0;
 
-    void twoThreadQuickSort(T *arr, const int lo, const int hi) {
-        if(lo >= hi)
+    void parallelQuickSort(T *arr, const int len) {
+        if (len <= 1)
             return;
-        
-        int tl = (hi-lo) / 3 + lo;
-        int tr = (hi-lo) / 3 * 2 + lo;
-        int p = 0;
-        while (p < tl || p > tr) {
-            p = partitionAdvance(arr, lo, hi);
-        }
-
-        //开一个线程排序[0...p-1]
-        thread t1 = thread(std::bind(&QuickSortMuiltThread::quickSortForSingleThread, this, arr, lo, p - 1));
-        //开一个线程排序[p+1...len-1]
-        thread t2 = thread(std::bind(&QuickSortMuiltThread::quickSortForSingleThread, this, arr, p + 1, hi));
-        t1.join();
-        t2.join();
+        TaskGroup group;
+        int grain = grainSize > 0 ? grainSize : autoGrainSize(len, group.threadPool().size());
+        //递归深度超过2*log(n)说明pivot选得很差，直接交给串行的内省排序
+        int depthLimit = 0;
+        for (int n = len; n > 1; n >>= 1)
+            depthLimit += 2;
+        parallelQuickSort(arr, 0, len - 1, grain, depthLimit, group);
+        group.wait();
     }
 
-    void fourThreadQuickSort(T *arr, const int len) {
-        fourThreadQuickSort(arr, 0, len - 1);
+private:
+    Compare comp;
+
+    //每个线程平均分到32个左右的任务，负载比较均衡，任务又不至于太碎
+    static int autoGrainSize(const int len, const unsigned threadNum) {
+        int grain = (int) (len / ((long long) threadNum * 32));
+        return std::max(grain, 1 << 14);
     }
 
-    void fourThreadQuickSort(T *arr, const int lo, const int hi) {
-        int tl = (hi-lo) / 3 + lo;
-        int tr = (hi-lo) / 3 * 2 + lo;
-        int p = 0;
-        while (p < tl || p > tr) {
-            p = partitionAdvance(arr, lo, hi);
+    void parallelQuickSort(T *arr, int lo, int hi, const int grain, int depthLimit, TaskGroup &group) {
+        while (hi - lo + 1 > grain) {
+            if (depthLimit-- == 0)
+                break;
+            int p = partitionAdvance(arr, lo, hi);
+            //较小的一半交给线程池，较大的一半留在当前线程继续拆分
+            if (p - lo < hi - p) {
+                int l = lo, r = p - 1;
+                group.run([this, arr, l, r, grain, depthLimit, &group]() {
+                    parallelQuickSort(arr, l, r, grain, depthLimit, group);
+                });
+                lo = p + 1;
+            } else {
+                int l = p + 1, r = hi;
+                group.run([this, arr, l, r, grain, depthLimit, &group]() {
+                    parallelQuickSort(arr, l, r, grain, depthLimit, group);
+                });
+                hi = p - 1;
+            }
         }
-        twoThreadQuickSort(arr, lo, p - 1);
-        twoThreadQuickSort(arr, p + 1, hi);
+        quickSortForSingleThread(arr, lo, hi);
     }
 
     void quickSortForSingleThread(T *arr, int lo, int hi) {
-        // quickSort3Ways(arr, lo, hi);
-        std::sort(arr+lo, arr+hi+1);
+        if (lo < hi)
+            std::sort(arr + lo, arr + hi + 1, comp);
     }
 
-    int partitionAdvance(T *arr, int lo, int hi) {
-        int randIndex = rand() % (hi - lo + 1) + lo;
-        swap(arr, lo, randIndex);
-        T pivot = arr[lo];
-        int i = lo + 1, j = hi;
-        while (true) {
-            while (i <= hi && arr[i] <= pivot) i++;
-            while (j >= lo + 1 && arr[j] >= pivot) j--;
-            if (i >= j)
-                break;
-            swap(arr, i, j);
+    //三数取中选择pivot，多个线程同时调用rand()会在glibc的锁上排队
+    int medianOf3(T *arr, int a, int b, int c) {
+        if (comp(arr[a], arr[b])) {
+            if (comp(arr[b], arr[c])) return b;
+            return comp(arr[a], arr[c]) ? c : a;
         }
-        /* 最后退出时arr[i] >= pivot，arr[j] =< pivot，
-        我们应该将小于pivot的数交换到第一个元素的位置，也就是
-        交换arr[j]和arr[lo]
-        */
-        swap(arr, lo, j);
-        return j;
+        if (comp(arr[a], arr[c])) return a;
+        return comp(arr[b], arr[c]) ? c : b;
     }
-    
+
+    int partitionAdvance(T *arr, int lo, int hi) {
+        int mid = lo + ((hi - lo) >> 1);
+        swap(arr, lo, medianOf3(arr, lo, mid, hi));
+        return Partition<T, Compare>::partition(arr, lo, hi, comp);
+    }
+
     void swap(T *arr, const int i, const int j) {
-        T k = arr[i];
-        arr[i] = arr[j];
-        arr[j] = k;
+        T k = std::move(arr[i]);
+        arr[i] = std::move(arr[j]);
+        arr[j] = std::move(k);
     }
 
     bool isSorted(T *arr, const int lo, const int hi) {
         for (int i = lo; i < hi; i++)
-            if (arr[i] > arr[i + 1])
+            if (comp(arr[i + 1], arr[i]))
                 return false;
         return true;
     }
@@ -0,0 +1,364 @@
+#ifndef RADIXSORT_HPP
+#define RADIXSORT_HPP
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "WorkStealingPool.hpp"
+
+/*
+ 基数排序用的键：把元素映射成一个无符号整数，无符号整数的大小顺序和元素的顺序一致
+   - 无符号整数：就是它本身；
+   - 有符号整数：翻转符号位，负数就排到了正数前面；
+   - 浮点数：正数翻转符号位，负数所有位取反(负数的绝对值越大，位模式越大)。
+ 记录类型自己提供一个同样形式的键函数，按记录里的某个整数字段排序。
+ */
+template<typename T, typename Enable = void>
+struct RadixKey;
+
+template<typename T>
+struct RadixKey<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+    typedef typename std::make_unsigned<T>::type Key;
+
+    Key operator()(const T &x) const {
+        if (std::is_signed<T>::value)
+            return (Key) x ^ ((Key) 1 << (sizeof(Key) * CHAR_BIT - 1));
+        return (Key) x;
+    }
+};
+
+template<>
+struct RadixKey<float> {
+    uint32_t operator()(const float &x) const {
+        uint32_t k;
+        memcpy(&k, &x, sizeof(k));
+        return (k & 0x80000000u) ? ~k : (k | 0x80000000u);
+    }
+};
+
+template<>
+struct RadixKey<double> {
+    uint64_t operator()(const double &x) const {
+        uint64_t k;
+        memcpy(&k, &x, sizeof(k));
+        return (k & 0x8000000000000000ull) ? ~k : (k | 0x8000000000000000ull);
+    }
+};
+
+//字符串按字节比较，没有定长的键，由RadixSort<std::string>特化处理
+template<>
+struct RadixKey<std::string> {
+};
+
+/*
+ 定长整数键的基数排序，每趟处理8位
+   - sortIterative: LSD，从最低位开始，每一趟都是稳定的计数排序，需要一个同样大小的辅助数组；
+   - sortRecursive: MSD(American flag)，从最高位开始原地分桶，再对每个桶递归，不需要辅助数组；
+   - sortAdvanced: 并行LSD，每个线程统计自己那一段的直方图，前缀和算出每个线程在每个桶里的写入位置，
+     再各自并行地把元素分发过去。
+ 所有元素在某一位上都相同的趟直接跳过，比如小范围的int只需要排低位的几趟。
+ */
+template<typename T, typename KeyOf = RadixKey<T> >
+class RadixSort {
+public:
+    typedef typename std::decay<decltype(std::declval<KeyOf>()(std::declval<const T &>()))>::type Key;
+
+    static_assert(std::is_integral<Key>::value && std::is_unsigned<Key>::value,
+                  "RadixSort needs a key function returning an unsigned integer");
+
+    explicit RadixSort(KeyOf keyOf = KeyOf()) : keyOf(keyOf) {}
+
+    void sortIterative(T *arr, const int len) {
+        lsdSort(arr, len);
+    }
+
+    void sortRecursive(T *arr, const int len) {
+        americanFlagSort(arr, 0, len, (PASSES - 1) * RADIX_BITS);
+    }
+
+    void sortAdvanced(T *arr, const int len) {
+        parallelLsdSort(arr, len);
+    }
+
+private:
+    static const int RADIX_BITS = 8;
+    static const int BUCKETS = 1 << RADIX_BITS;
+    static const int PASSES = (int) sizeof(Key);
+    //小于这个长度的桶用插入排序
+    static const int INSERTION_CUTOFF = 32;
+    //小于这个长度的数组不值得并行
+    static const int PARALLEL_CUTOFF = 1 << 16;
+
+    KeyOf keyOf;
+
+    int digit(const T &x, const int shift) const {
+        return (int) ((keyOf(x) >> shift) & (BUCKETS - 1));
+    }
+
+    void lsdSort(T *arr, const int len) {
+        if (len < 2)
+            return;
+        //一次遍历统计出所有趟的直方图
+        std::vector<int> count(PASSES * BUCKETS, 0);
+        for (int i = 0; i < len; i++) {
+            Key k = keyOf(arr[i]);
+            for (int p = 0; p < PASSES; p++)
+                count[p * BUCKETS + (int) ((k >> (p * RADIX_BITS)) & (BUCKETS - 1))]++;
+        }
+
+        std::vector<T> aux(len);
+        T *src = arr, *dst = aux.data();
+        for (int p = 0; p < PASSES; p++) {
+            int shift = p * RADIX_BITS;
+            int *c = &count[p * BUCKETS];
+            if (c[digit(src[0], shift)] == len)
+                continue;
+            int offset[BUCKETS];
+            for (int b = 0, sum = 0; b < BUCKETS; b++) {
+                offset[b] = sum;
+                sum += c[b];
+            }
+            for (int i = 0; i < len; i++)
+                dst[offset[digit(src[i], shift)]++] = std::move(src[i]);
+            std::swap(src, dst);
+        }
+        if (src != arr)
+            std::move(src, src + len, arr);
+    }
+
+    //对arr[lo, hi)按shift开始的这一位原地分桶，再递归处理更低的位
+    void americanFlagSort(T *arr, const int lo, const int hi, const int shift) {
+        if (hi - lo <= INSERTION_CUTOFF) {
+            insertionSort(arr, lo, hi);
+            return;
+        }
+        int count[BUCKETS] = {0};
+        for (int i = lo; i < hi; i++)
+            count[digit(arr[i], shift)]++;
+        int head[BUCKETS], tail[BUCKETS];
+        for (int b = 0, pos = lo; b < BUCKETS; b++) {
+            head[b] = pos;
+            pos += count[b];
+            tail[b] = pos;
+        }
+        //每个元素沿着置换环换到它所在桶的下一个空位上
+        for (int b = 0; b < BUCKETS; b++) {
+            while (head[b] < tail[b]) {
+                T x = std::move(arr[head[b]]);
+                int d = digit(x, shift);
+                while (d != b) {
+                    std::swap(x, arr[head[d]++]);
+                    d = digit(x, shift);
+                }
+                arr[head[b]++] = std::move(x);
+            }
+        }
+        if (shift == 0)
+            return;
+        for (int b = 0, start = lo; b < BUCKETS; b++) {
+            if (tail[b] - start > 1)
+                americanFlagSort(arr, start, tail[b], shift - RADIX_BITS);
+            start = tail[b];
+        }
+    }
+
+    void insertionSort(T *arr, const int lo, const int hi) {
+        for (int i = lo + 1; i < hi; i++) {
+            T x = std::move(arr[i]);
+            Key k = keyOf(x);
+            int j = i;
+            for (; j > lo && k < keyOf(arr[j - 1]); j--)
+                arr[j] = std::move(arr[j - 1]);
+            arr[j] = std::move(x);
+        }
+    }
+
+    void parallelLsdSort(T *arr, const int len) {
+        if (len < PARALLEL_CUTOFF) {
+            lsdSort(arr, len);
+            return;
+        }
+        TaskGroup group;
+        int chunks = (int) std::min<long long>(group.threadPool().size(), len / (PARALLEL_CUTOFF / 4));
+        std::vector<int> bound(chunks + 1);
+        for (int c = 0; c <= chunks; c++)
+            bound[c] = (int) ((long long) len * c / chunks);
+        //count[c * BUCKETS + b]: 第c段中当前位是b的元素个数，分发时原地变成写入位置
+        std::vector<int> count(chunks * BUCKETS);
+
+        std::vector<T> aux(len);
+        T *src = arr, *dst = aux.data();
+        for (int p = 0; p < PASSES; p++) {
+            int shift = p * RADIX_BITS;
+            std::fill(count.begin(), count.end(), 0);
+            for (int c = 0; c < chunks; c++) {
+                group.run([this, src, shift, c, &bound, &count]() {
+                    int *h = &count[c * BUCKETS];
+                    for (int i = bound[c]; i < bound[c + 1]; i++)
+                        h[digit(src[i], shift)]++;
+                });
+            }
+            group.wait();
+
+            //按(桶, 段)的顺序做前缀和，同一个桶里前面段的元素排在前面，保证稳定
+            bool skip = false;
+            for (int b = 0, sum = 0; b < BUCKETS; b++) {
+                int total = 0;
+                for (int c = 0; c < chunks; c++) {
+                    int n = count[c * BUCKETS + b];
+                    count[c * BUCKETS + b] = sum;
+                    sum += n;
+                    total += n;
+                }
+                if (total == len)
+                    skip = true;
+            }
+            if (skip)
+                continue;
+
+            for (int c = 0; c < chunks; c++) {
+                group.run([this, src, dst, shift, c, &bound, &count]() {
+                    int *offset = &count[c * BUCKETS];
+                    for (int i = bound[c]; i < bound[c + 1]; i++)
+                        dst[offset[digit(src[i], shift)]++] = std::move(src[i]);
+                });
+            }
+            group.wait();
+            std::swap(src, dst);
+        }
+
+        if (src != arr) {
+            for (int c = 0; c < chunks; c++) {
+                group.run([src, arr, c, &bound]() {
+                    std::move(src + bound[c], src + bound[c + 1], arr + bound[c]);
+                });
+            }
+            group.wait();
+        }
+    }
+};
+
+/*
+ 字符串的MSD基数排序(American flag)
+ 按第d个字节原地分成257个桶，0号桶放长度正好为d的字符串(它们已经相等了，不用再排)，
+ 其它桶递归地按第d+1个字节排序。
+   - sortIterative: 用显式栈代替递归，很长的公共前缀也不会把调用栈撑爆；
+   - sortRecursive: 递归版本；
+   - sortAdvanced: 较大的桶作为子任务交给工作窃取线程池并行排序。
+ */
+template<>
+class RadixSort<std::string, RadixKey<std::string> > {
+public:
+    void sortIterative(std::string *arr, const int len) {
+        std::vector<Range> stack;
+        stack.push_back(Range(0, len, 0));
+        while (!stack.empty()) {
+            Range r = stack.back();
+            stack.pop_back();
+            if (r.hi - r.lo <= INSERTION_CUTOFF) {
+                insertionSort(arr, r.lo, r.hi, r.d);
+                continue;
+            }
+            int tail[BUCKETS];
+            partition(arr, r.lo, r.hi, r.d, tail);
+            for (int b = 1; b < BUCKETS; b++)
+                if (tail[b] - tail[b - 1] > 1)
+                    stack.push_back(Range(tail[b - 1], tail[b], r.d + 1));
+        }
+    }
+
+    void sortRecursive(std::string *arr, const int len) {
+        msdSort(arr, 0, len, 0);
+    }
+
+    void sortAdvanced(std::string *arr, const int len) {
+        TaskGroup group;
+        parallelMsdSort(arr, 0, len, 0, group);
+        group.wait();
+    }
+
+private:
+    static const int BUCKETS = 257;
+    static const int INSERTION_CUTOFF = 32;
+    //小于这个长度的桶不再拆成子任务
+    static const int PARALLEL_CUTOFF = 1 << 13;
+
+    struct Range {
+        int lo, hi, d;
+
+        Range(int lo, int hi, int d) : lo(lo), hi(hi), d(d) {}
+    };
+
+    static int charAt(const std::string &s, const int d) {
+        return d < (int) s.size() ? (unsigned char) s[d] + 1 : 0;
+    }
+
+    //把arr[lo, hi)按第d个字节原地分桶，tail[b]是第b个桶的结束位置
+    void partition(std::string *arr, const int lo, const int hi, const int d, int *tail) {
+        int count[BUCKETS] = {0};
+        for (int i = lo; i < hi; i++)
+            count[charAt(arr[i], d)]++;
+        int head[BUCKETS];
+        for (int b = 0, pos = lo; b < BUCKETS; b++) {
+            head[b] = pos;
+            pos += count[b];
+            tail[b] = pos;
+        }
+        for (int b = 0; b < BUCKETS; b++) {
+            while (head[b] < tail[b]) {
+                int c = charAt(arr[head[b]], d);
+                //std::string的swap只交换内部指针，不拷贝字符
+                while (c != b) {
+                    arr[head[b]].swap(arr[head[c]++]);
+                    c = charAt(arr[head[b]], d);
+                }
+                head[b]++;
+            }
+        }
+    }
+
+    void msdSort(std::string *arr, const int lo, const int hi, const int d) {
+        if (hi - lo <= INSERTION_CUTOFF) {
+            insertionSort(arr, lo, hi, d);
+            return;
+        }
+        int tail[BUCKETS];
+        partition(arr, lo, hi, d, tail);
+        for (int b = 1; b < BUCKETS; b++)
+            if (tail[b] - tail[b - 1] > 1)
+                msdSort(arr, tail[b - 1], tail[b], d + 1);
+    }
+
+    void parallelMsdSort(std::string *arr, const int lo, const int hi, const int d, TaskGroup &group) {
+        if (hi - lo <= PARALLEL_CUTOFF) {
+            msdSort(arr, lo, hi, d);
+            return;
+        }
+        int tail[BUCKETS];
+        partition(arr, lo, hi, d, tail);
+        for (int b = 1; b < BUCKETS; b++) {
+            int l = tail[b - 1], r = tail[b];
+            if (r - l <= 1)
+                continue;
+            group.run([this, arr, l, r, d, &group]() {
+                parallelMsdSort(arr, l, r, d + 1, group);
+            });
+        }
+    }
+
+    //前d个字节都相同，只比较后面的部分
+    void insertionSort(std::string *arr, const int lo, const int hi, const int d) {
+        for (int i = lo + 1; i < hi; i++) {
+            for (int j = i; j > lo && arr[j].compare(d, std::string::npos, arr[j - 1], d, std::string::npos) < 0; j--)
+                arr[j].swap(arr[j - 1]);
+        }
+    }
+};
+
+#endif //RADIXSORT_HPP
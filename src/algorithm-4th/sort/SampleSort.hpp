@@ -0,0 +1,415 @@
+#ifndef SAMPLESORT_HPP
+#define SAMPLESORT_HPP
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "QuickSort.hpp"
+#include "WorkStealingPool.hpp"
+
+/*
+ 并行原地样本排序(IPS4o的简化版)
+ 快速排序每次只把数组分成两份，样本排序一次分成K=256个桶，递归层数少得多，每一层都是顺序扫描。
+ 一轮分桶分四步：
+   1. 抽样：随机抽K*alpha个元素排好序，等间隔取K-1个作分隔符，按隐式二叉树存放，
+      分类一个元素就是从树根走logK步，每步一次比较、没有分支，一次还能交错分类8个元素；
+      抽到重复的分隔符时再给每个分隔符加一个"等于桶"，大量重复的元素直接放进等于桶不再递归；
+   2. 分类：数组按块(2KB)对齐切成若干条带，每个线程扫描自己的条带，元素先放进每个桶的块缓冲区，
+      缓冲区满了就整块写回条带里已经扫描过的位置，扫描完条带的前半部分都是"满块"，每块只属于一个桶；
+   3. 块置换：按桶的大小算出每个桶对齐后的区域，各线程并发地从桶里取出放错位置的满块，
+      写到它所属桶的下一个空位，空位上原来的块再换出来继续放，每个桶只用一把锁保护读写指针；
+   4. 收尾：桶的边界不一定对齐到块，把越过边界的部分和各线程缓冲区里剩下的元素填进桶首尾的空隙。
+ 之后每个桶作为一个任务交给工作窃取线程池继续递归，小的桶直接用QuickSort::sortAdvanced。
+ 除了每个条带numBuckets个块大小的缓冲区(不超过n/8)，不需要和原数组一样大的辅助数组。
+ */
+template<typename T, typename Compare = std::less<T> >
+class SampleSort {
+public:
+    explicit SampleSort(Compare comp = Compare()) : comp(comp) {}
+
+    void sortIterative(T *arr, const int len) {
+        parallelSampleSort(arr, len);
+    }
+
+    void sortRecursive(T *arr, const int len) {
+        parallelSampleSort(arr, len);
+    }
+
+    void sortAdvanced(T *arr, const int len) {
+        parallelSampleSort(arr, len);
+    }
+
+public:
+    //参与分类的条带数，0表示线程池的线程数
+    int threadNum = 0;
+
+    void parallelSampleSort(T *arr, const int len) {
+        if (len <= 1)
+            return;
+        TaskGroup group;
+        int stripes = threadNum > 0 ? threadNum : (int) group.threadPool().size();
+        //每一层桶的大小大约缩小K倍，层数超过预期的两倍说明抽样一直很差，剩下的交给串行排序
+        int depthLimit = 1;
+        for (long long n = len; n > 1; n >>= LOG_BUCKETS)
+            depthLimit += 2;
+        sampleSortStep(arr, len, stripes, depthLimit, group);
+        group.wait();
+    }
+
+private:
+    static const int LOG_BUCKETS = 8;
+    static const int BUCKETS = 1 << LOG_BUCKETS;
+    static const int BLOCK_BYTES = 2048;
+    static const int BLOCK = sizeof(T) >= BLOCK_BYTES ? 1 : BLOCK_BYTES / (int) sizeof(T);
+    static const int UNROLL = 8;
+    //小于这个长度不再分桶
+    static const long long BASE_CASE_SIZE = 4LL * BUCKETS * BLOCK;
+
+    Compare comp;
+
+    //分类器：分隔符的隐式二叉树，tree[1]是根，tree[j]的孩子是tree[2j]和tree[2j+1]
+    struct Classifier {
+        std::vector<T> tree;
+        std::vector<T> splitters;   //排好序的K-1个分隔符
+        bool equalBuckets;
+
+        int numBuckets() const {
+            return equalBuckets ? 2 * BUCKETS - 1 : BUCKETS;
+        }
+    };
+
+    //块置换时一个桶的读写指针：[write, read)之间是还没处理的块，write之前是已经放好的块
+    struct Bucket {
+        std::mutex mutex;
+        long long write;
+        long long read;
+    };
+
+    //一个条带的分类结果
+    struct Stripe {
+        long long begin;
+        long long end;
+        std::vector<T> buffer;      //每个桶一个块大小的缓冲区
+        std::vector<int> fill;      //每个桶缓冲区里剩下的元素个数
+        std::vector<long long> count;
+    };
+
+    //一轮分桶的共享状态
+    struct Step {
+        T *arr;
+        long long n;
+        Classifier classifier;
+        std::vector<Stripe> stripes;
+        std::vector<int> blockBucket;   //每个满块属于哪个桶，-1表示空块
+        std::unique_ptr<Bucket[]> buckets;
+        std::vector<long long> bucketStart; //桶i最终的位置是[bucketStart[i], bucketStart[i+1])
+        std::vector<T> overflow;        //跨过数组末尾的那一块
+        int overflowBucket;             //overflow属于哪个桶，-1表示没有
+    };
+
+    void sampleSortStep(T *arr, const long long n, int stripes, const int depthLimit, TaskGroup &group) {
+        if (n < BASE_CASE_SIZE || depthLimit == 0) {
+            sortSequential(arr, (int) n, comp);
+            return;
+        }
+        //缓冲区一共占stripes*numBuckets个块，条带数限制在让它不超过n/8
+        stripes = (int) std::max(1LL, std::min((long long) stripes, n / (8LL * 2 * BUCKETS * BLOCK)));
+
+        Step step;
+        step.arr = arr;
+        step.n = n;
+        step.overflowBucket = -1;
+        chooseSplitters(arr, n, step.classifier);
+        const int numBuckets = step.classifier.numBuckets();
+
+        long long numBlocks = (n + BLOCK - 1) / BLOCK;
+        step.blockBucket.assign(numBlocks, -1);
+        step.stripes.resize(stripes);
+        for (int s = 0; s < stripes; s++) {
+            step.stripes[s].begin = numBlocks * s / stripes * BLOCK;
+            step.stripes[s].end = std::min(n, numBlocks * (s + 1) / stripes * BLOCK);
+        }
+        forEachStripe(stripes, [this, &step](int s) {
+            classifyStripe(step, step.stripes[s]);
+        });
+
+        //每个桶的最终位置，以及对齐到块之后的区域[align(bucketStart[i]), align(bucketStart[i+1]))
+        step.bucketStart.assign(numBuckets + 1, 0);
+        for (int b = 0; b < numBuckets; b++) {
+            long long total = 0;
+            for (int s = 0; s < stripes; s++)
+                total += step.stripes[s].count[b];
+            step.bucketStart[b + 1] = step.bucketStart[b] + total;
+        }
+        step.buckets.reset(new Bucket[numBuckets]);
+        for (int b = 0; b < numBuckets; b++) {
+            step.buckets[b].write = alignBlock(step.bucketStart[b]);
+            step.buckets[b].read = alignBlock(step.bucketStart[b + 1]);
+        }
+        step.overflow.resize(BLOCK);
+
+        forEachStripe(stripes, [this, &step, numBuckets, stripes](int s) {
+            permuteBlocks(step, (int) ((long long) numBuckets * s / stripes));
+        });
+
+        cleanup(step, stripes);
+
+        //递归排序每个桶，等于桶里的元素都相等，不用再排
+        for (int b = 0; b < numBuckets; b++) {
+            if (step.classifier.equalBuckets && (b & 1))
+                continue;
+            long long lo = step.bucketStart[b], m = step.bucketStart[b + 1] - lo;
+            if (m <= 1)
+                continue;
+            T *sub = arr + lo;
+            if (m < BASE_CASE_SIZE) {
+                group.run([this, sub, m]() {
+                    sortSequential(sub, (int) m, comp);
+                });
+            } else {
+                int childStripes = (int) std::max(1LL, stripes * m / n);
+                group.run([this, sub, m, childStripes, depthLimit, &group]() {
+                    sampleSortStep(sub, m, childStripes, depthLimit - 1, group);
+                });
+            }
+        }
+    }
+
+    //基本类型用QuickSort::sortAdvanced(pdqsort+排序网络)，自定义比较器用std::sort
+    static void sortSequential(T *arr, const int len, const std::less<T> &) {
+        QuickSort<T>().sortAdvanced(arr, len);
+    }
+
+    template<typename C>
+    static void sortSequential(T *arr, const int len, const C &c) {
+        std::sort(arr, arr + len, c);
+    }
+
+    //条带只有一个时直接在当前线程做，否则每个条带一个任务，等所有条带做完再返回
+    template<typename F>
+    void forEachStripe(const int stripes, const F &f) {
+        if (stripes == 1) {
+            f(0);
+            return;
+        }
+        TaskGroup phase;
+        for (int s = 0; s < stripes; s++)
+            phase.run([&f, s]() { f(s); });
+        phase.wait();
+    }
+
+    static long long alignBlock(const long long pos) {
+        return (pos + BLOCK - 1) / BLOCK * BLOCK;
+    }
+
+    //随机抽样放到数组开头，排好序后等间隔取分隔符，样本本身仍然参与后面的分类
+    void chooseSplitters(T *arr, const long long n, Classifier &classifier) {
+        int logN = 0;
+        for (long long m = n; m > 1; m >>= 1)
+            logN++;
+        int alpha = std::max(1, logN / 5);
+        long long sampleSize = (long long) BUCKETS * alpha;
+        std::minstd_rand rng((unsigned) n);
+        for (long long i = 0; i < sampleSize; i++) {
+            std::uniform_int_distribution<long long> pick(i, n - 1);
+            std::swap(arr[i], arr[pick(rng)]);
+        }
+        sortSequential(arr, (int) sampleSize, comp);
+
+        classifier.splitters.resize(BUCKETS - 1);
+        classifier.equalBuckets = false;
+        for (int j = 0; j < BUCKETS - 1; j++) {
+            classifier.splitters[j] = arr[(long long) (j + 1) * alpha];
+            if (j > 0 && !comp(classifier.splitters[j - 1], classifier.splitters[j]))
+                classifier.equalBuckets = true;
+        }
+        classifier.tree.resize(BUCKETS);
+        buildTree(classifier, 1, 0, BUCKETS - 1);
+    }
+
+    void buildTree(Classifier &classifier, const int node, const int lo, const int hi) {
+        if (lo >= hi)
+            return;
+        int mid = lo + ((hi - lo) >> 1);
+        classifier.tree[node] = classifier.splitters[mid];
+        buildTree(classifier, 2 * node, lo, mid);
+        buildTree(classifier, 2 * node + 1, mid + 1, hi);
+    }
+
+    //叶子编号b是不大于x的分隔符个数，有等于桶时x等于splitters[b-1]放进等于桶2b-1，否则放进2b
+    int bucketOf(const Classifier &classifier, const T &x, const int leaf) {
+        int b = leaf - BUCKETS;
+        if (!classifier.equalBuckets)
+            return b;
+        return 2 * b - (b > 0 && !comp(classifier.splitters[b - 1], x));
+    }
+
+    int classify(const Classifier &classifier, const T &x) {
+        int j = 1;
+        for (int l = 0; l < LOG_BUCKETS; l++)
+            j = 2 * j + !comp(x, classifier.tree[j]);
+        return bucketOf(classifier, x, j);
+    }
+
+    //扫描条带，元素放进对应桶的缓冲区，缓冲区满了整块写回条带前部已经扫描过的位置
+    void classifyStripe(Step &step, Stripe &stripe) {
+        const Classifier &classifier = step.classifier;
+        const int numBuckets = classifier.numBuckets();
+        T *arr = step.arr;
+        stripe.buffer.resize((size_t) numBuckets * BLOCK);
+        stripe.fill.assign(numBuckets, 0);
+        stripe.count.assign(numBuckets, 0);
+        long long out = stripe.begin;
+        auto push = [&](long long i, int b) {
+            T *buf = &stripe.buffer[(size_t) b * BLOCK];
+            buf[stripe.fill[b]++] = std::move(arr[i]);
+            if (stripe.fill[b] == BLOCK) {
+                std::move(buf, buf + BLOCK, arr + out);
+                step.blockBucket[out / BLOCK] = b;
+                out += BLOCK;
+                stripe.fill[b] = 0;
+                stripe.count[b] += BLOCK;
+            }
+        };
+
+        long long i = stripe.begin;
+        //8个元素交错着走分类树，比较之间没有依赖，能同时在流水线里执行
+        for (; i + UNROLL <= stripe.end; i += UNROLL) {
+            int j[UNROLL];
+            for (int k = 0; k < UNROLL; k++)
+                j[k] = 1;
+            for (int l = 0; l < LOG_BUCKETS; l++)
+                for (int k = 0; k < UNROLL; k++)
+                    j[k] = 2 * j[k] + !comp(arr[i + k], classifier.tree[j[k]]);
+            for (int k = 0; k < UNROLL; k++)
+                j[k] = bucketOf(classifier, arr[i + k], j[k]);
+            for (int k = 0; k < UNROLL; k++)
+                push(i + k, j[k]);
+        }
+        for (; i < stripe.end; i++)
+            push(i, classify(classifier, arr[i]));
+        for (int b = 0; b < numBuckets; b++)
+            stripe.count[b] += stripe.fill[b];
+    }
+
+    //从桶b里取出一个还没处理的满块放进buf，返回它属于哪个桶，桶b里没有了返回-1
+    int takeBlock(Step &step, const int b, T *buf) {
+        Bucket &bucket = step.buckets[b];
+        std::lock_guard<std::mutex> lock(bucket.mutex);
+        while (bucket.read > bucket.write && step.blockBucket[(bucket.read - BLOCK) / BLOCK] < 0)
+            bucket.read -= BLOCK;
+        if (bucket.read <= bucket.write)
+            return -1;
+        bucket.read -= BLOCK;
+        //拷贝完才释放锁，别的线程在这之后才可能往这个位置写
+        std::move(step.arr + bucket.read, step.arr + bucket.read + BLOCK, buf);
+        return step.blockBucket[bucket.read / BLOCK];
+    }
+
+    //把buf里的块写到桶dest的下一个位置，那里如果还有没处理的满块就先换出来接着放，直到写进一个空位
+    void placeBlock(Step &step, int dest, T *buf, T *spare) {
+        while (true) {
+            long long slot;
+            int next = -1;
+            {
+                Bucket &bucket = step.buckets[dest];
+                std::lock_guard<std::mutex> lock(bucket.mutex);
+                slot = bucket.write;
+                bucket.write += BLOCK;
+                if (slot < bucket.read)
+                    next = step.blockBucket[slot / BLOCK];
+            }
+            T *pos = step.arr + slot;
+            if (slot + BLOCK > step.n) {
+                //只有最后一个非空桶的最后一块可能越过数组末尾，先放到overflow里，收尾时再填回去
+                std::move(buf, buf + BLOCK, step.overflow.begin());
+                step.overflowBucket = dest;
+                return;
+            }
+            if (next < 0) {
+                std::move(buf, buf + BLOCK, pos);
+                return;
+            }
+            std::move(pos, pos + BLOCK, spare);
+            std::move(buf, buf + BLOCK, pos);
+            std::swap(buf, spare);
+            dest = next;
+        }
+    }
+
+    //每个线程从不同的桶开始，把每个桶里的满块取完；读写指针只会相向移动，取完的桶不会再有新的满块
+    void permuteBlocks(Step &step, const int firstBucket) {
+        const int numBuckets = step.classifier.numBuckets();
+        std::vector<T> swapBuffer(2 * BLOCK);
+        T *buf = &swapBuffer[0], *spare = &swapBuffer[BLOCK];
+        for (int k = 0; k < numBuckets; k++) {
+            int b = (firstBucket + k) % numBuckets;
+            int dest;
+            while ((dest = takeBlock(step, b, buf)) >= 0)
+                placeBlock(step, dest, buf, spare);
+        }
+    }
+
+    /*
+     置换完成后桶b的满块在[align(start), write)，最终位置是[start, end)：
+       - 满块越过end的部分落在下一个桶的开头，先统一搬到saved里，免得被下一个桶覆盖；
+       - 然后每个桶用saved、overflow和各条带缓冲区里的元素填满[start, align(start))和[write, end)。
+     两步各自按桶分给各个条带并行，桶与桶之间写的位置互不重叠。
+     */
+    void cleanup(Step &step, const int stripes) {
+        const int numBuckets = step.classifier.numBuckets();
+        T *arr = step.arr;
+        std::vector<long long> written(numBuckets);
+        std::vector<long long> savedStart(numBuckets + 1, 0);
+        for (int b = 0; b < numBuckets; b++) {
+            written[b] = step.buckets[b].write;
+            if (b == step.overflowBucket)
+                written[b] -= BLOCK;
+            long long begin = std::max(alignBlock(step.bucketStart[b]), step.bucketStart[b + 1]);
+            savedStart[b + 1] = savedStart[b] + std::max(0LL, written[b] - begin);
+        }
+        std::vector<T> saved(savedStart[numBuckets]);
+
+        forEachStripe(stripes, [&](int s) {
+            for (int b = numBuckets * s / stripes; b < numBuckets * (s + 1) / stripes; b++) {
+                long long size = savedStart[b + 1] - savedStart[b];
+                std::move(arr + written[b] - size, arr + written[b], saved.begin() + savedStart[b]);
+            }
+        });
+
+        forEachStripe(stripes, [&](int s) {
+            for (int b = numBuckets * s / stripes; b < numBuckets * (s + 1) / stripes; b++) {
+                long long lo = step.bucketStart[b], hi = step.bucketStart[b + 1];
+                long long keepBegin = alignBlock(lo), keepEnd = std::min(written[b], hi);
+                bool keep = keepBegin < keepEnd;
+                long long pos = lo, gapEnd = keep ? keepBegin : hi;
+                auto put = [&](T &x) {
+                    if (pos == gapEnd) {
+                        pos = keepEnd;
+                        gapEnd = hi;
+                    }
+                    arr[pos++] = std::move(x);
+                };
+                for (long long i = savedStart[b]; i < savedStart[b + 1]; i++)
+                    put(saved[i]);
+                if (b == step.overflowBucket)
+                    for (int i = 0; i < BLOCK; i++)
+                        put(step.overflow[i]);
+                for (int t = 0; t < stripes; t++) {
+                    Stripe &stripe = step.stripes[t];
+                    T *buf = &stripe.buffer[(size_t) b * BLOCK];
+                    for (int i = 0; i < stripe.fill[b]; i++)
+                        put(buf[i]);
+                }
+            }
+        });
+    }
+};
+
+
+#endif //SAMPLESORT_HPP
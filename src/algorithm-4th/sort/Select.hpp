@@ -0,0 +1,189 @@
+#ifndef SELECT_HPP
+#define SELECT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "HeapSort.hpp"
+#include "Partition.hpp"
+#include "QuickSort.hpp"
+#include "WorkStealingPool.hpp"
+
+/*
+ 选择：只要最小的k个元素或者第k小的元素时，不用把整个数组排好序
+   - nthElement: 内省选择。大区间用Floyd-Rivest选pivot：先在k附近大小约n^(2/3)的一段里递归选出第k小，
+     用它作pivot做一次partition，区间通常一下就缩小到这一段的大小，比较次数接近n+min(k, n-k)；
+     小区间取三数中值；partition的次数超过2log2(n)还没选出来，说明输入在针对pivot的选法，改用堆选择，最坏O(nlogk)；
+   - topKHeap: 前k个元素建成d叉大顶堆，扫描后面的元素，比堆顶小就替换堆顶再下沉，O(nlogk)，只顺序扫描一遍；
+   - topKPartition: 用nthElement把最小的k个换到前面，再排序这k个，O(n + klogk)；
+   - partialSort: 按k的大小在上面两种里选，k不超过len/16384时用堆；
+   - parallelTopK: 数组切成线程数份，每个线程在自己那一份上选出最小的k个，
+     再把各份的候选集中到数组开头，在这些候选里选一次。
+ 除了nthElement，结果都是arr[0, k)从小到大有序，arr[k, len)是其余元素，顺序不定。
+ */
+template<typename T>
+class Select {
+public:
+    //第k小(从0开始)的元素放到arr[k]，并且arr[0, k) <= arr[k] <= arr(k, len)
+    void nthElement(T *arr, const int len, const int k) {
+        if (k < 0 || k >= len)
+            return;
+        int limit = 0;
+        for (int n = len; n > 1; n >>= 1)
+            limit += 2;
+        introSelect(arr, 0, len - 1, k, limit);
+    }
+
+    void topKHeap(T *arr, const int len, int k) {
+        k = std::min(k, len);
+        if (k <= 0)
+            return;
+        heapSelect(arr, len, k);
+        for (int i = k; i > 1; i--)
+            Heap::popDHeap(arr, i);
+    }
+
+    void topKPartition(T *arr, const int len, int k) {
+        k = std::min(k, len);
+        if (k <= 0)
+            return;
+        nthElement(arr, len, k - 1);
+        //arr[k-1]已经是这k个里最大的
+        QuickSort<T>().sortAdvanced(arr, k - 1);
+    }
+
+    //k很小时堆只要扫描一遍，几乎不写数组；k稍大一点下沉就比Floyd-Rivest的partition慢了
+    void partialSort(T *arr, const int len, const int k) {
+        if (useHeap(len, k))
+            topKHeap(arr, len, k);
+        else
+            topKPartition(arr, len, k);
+    }
+
+public:
+    //parallelTopK切分的份数，0表示线程池的线程数
+    int threadNum = 0;
+
+    void parallelTopK(T *arr, const int len, int k) {
+        k = std::min(k, len);
+        if (k <= 0)
+            return;
+        TaskGroup group;
+        int parts = threadNum > 0 ? threadNum : (int) group.threadPool().size();
+        //每份要比k大得多，不然各份的候选加起来和原数组差不多大
+        parts = (int) std::min<long long>(parts, len / ((long long) k * PARALLEL_PART_RATIO));
+        if (parts <= 1 || len < PARALLEL_MIN_LENGTH) {
+            partialSort(arr, len, k);
+            return;
+        }
+        std::vector<int> begin(parts + 1);
+        for (int p = 0; p <= parts; p++)
+            begin[p] = (int) ((long long) len * p / parts);
+        for (int p = 0; p < parts; p++) {
+            T *part = arr + begin[p];
+            int size = begin[p + 1] - begin[p];
+            group.run([this, part, size, k]() { selectSmallest(part, size, k); });
+        }
+        group.wait();
+        //每份的候选在它的开头，依次换到数组前面，每份都不短于k，写的位置不会超过读的位置
+        int candidates = 0;
+        for (int p = 0; p < parts; p++) {
+            std::swap_ranges(arr + begin[p], arr + begin[p] + k, arr + candidates);
+            candidates += k;
+        }
+        partialSort(arr, candidates, k);
+    }
+
+private:
+    typedef HeapSort<T> Heap;
+
+    static const int INSERTION_SORT_THRESHOLD = 24;
+    static const int FLOYD_RIVEST_THRESHOLD = 600;
+    static const int HEAP_SELECT_RATIO = 1 << 14;
+    static const int PARALLEL_PART_RATIO = 16;
+    static const int PARALLEL_MIN_LENGTH = 1 << 16;
+
+    static bool useHeap(const int len, const int k) {
+        return (long long) k * HEAP_SELECT_RATIO <= len;
+    }
+
+    //最小的k个元素换到arr[0, k)，顺序不定
+    void selectSmallest(T *arr, const int len, const int k) {
+        if (useHeap(len, k))
+            heapSelect(arr, len, k);
+        else
+            nthElement(arr, len, k - 1);
+    }
+
+    //arr[0, k)变成最小的k个元素组成的大顶堆，arr[0]是其中最大的
+    static void heapSelect(T *arr, const int len, const int k) {
+        Heap::buildDHeap(arr, k);
+        for (int i = k; i < len; i++) {
+            if (arr[i] < arr[0]) {
+                std::swap(arr[i], arr[0]);
+                Heap::ShiftDownInDHeap(arr, 0, k);
+            }
+        }
+    }
+
+    void introSelect(T *arr, int lo, int hi, const int k, int limit) {
+        while (hi - lo + 1 > INSERTION_SORT_THRESHOLD) {
+            if (limit-- == 0) {
+                //arr[lo...k]要放最小的k-lo+1个，堆顶就是第k小
+                heapSelect(arr + lo, hi - lo + 1, k - lo + 1);
+                std::swap(arr[lo], arr[k]);
+                return;
+            }
+            const int n = hi - lo + 1;
+            if (n > FLOYD_RIVEST_THRESHOLD) {
+                //[sampleLo, sampleHi]包含k，长度约n^(2/3)，按k在区间里的相对位置取，第k小大概率落在这一段里
+                const int i = k - lo + 1;
+                const double z = std::log((double) n);
+                const double s = 0.5 * std::exp(2 * z / 3);
+                double sd = 0.5 * std::sqrt(z * s * (n - s) / n);
+                if (i < n / 2)
+                    sd = -sd;
+                int sampleLo = std::max(lo, (int) (k - i * s / n + sd));
+                int sampleHi = std::min(hi, (int) (k + (n - i) * s / n + sd));
+                introSelect(arr, sampleLo, sampleHi, k, limit);
+                std::swap(arr[lo], arr[k]);
+            } else {
+                medianOf3ToFront(arr, lo, lo + n / 2, hi);
+            }
+            //arr[lo...p-1] <= arr[p] <= arr[p+1...hi]
+            int p = Partition<T>::partition(arr, lo, hi);
+            if (p == k)
+                return;
+            if (k < p)
+                hi = p - 1;
+            else
+                lo = p + 1;
+        }
+        insertionSort(arr, lo, hi);
+    }
+
+    //arr[a]、arr[b]、arr[c]的中位数换到arr[a]
+    static void medianOf3ToFront(T *arr, const int a, const int b, const int c) {
+        int m;
+        if (arr[a] < arr[b])
+            m = arr[b] < arr[c] ? b : (arr[a] < arr[c] ? c : a);
+        else
+            m = arr[a] < arr[c] ? a : (arr[b] < arr[c] ? c : b);
+        std::swap(arr[a], arr[m]);
+    }
+
+    static void insertionSort(T *arr, const int lo, const int hi) {
+        for (int i = lo + 1; i <= hi; i++) {
+            T target = std::move(arr[i]);
+            int j = i;
+            for (; j > lo && target < arr[j - 1]; j--)
+                arr[j] = std::move(arr[j - 1]);
+            arr[j] = std::move(target);
+        }
+    }
+};
+
+
+#endif //SELECT_HPP
@@ -1,6 +1,8 @@
 #ifndef SELECTSORT_HPP
 #define SELECTSORT_HPP
 
+#include <utility>
+
 
 template<typename T>
 class SelectSort {
@@ -76,9 +78,9 @@ private:
     }
 
     void swap(T *arr, const int i, const int j) {
-        T k = arr[i];
-        arr[i] = arr[j];
-        arr[j] = k;
+        T k = std::move(arr[i]);
+        arr[i] = std::move(arr[j]);
+        arr[j] = std::move(k);
     }
 
     bool isSorted(T *arr, const int lo, const int hi) {
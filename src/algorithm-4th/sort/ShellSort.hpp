@@ -1,6 +1,8 @@
 #ifndef SHELLSORT_HPP
 #define SHELLSORT_HPP
 
+#include <utility>
+
 template<typename T>
 class ShellSort {
 
@@ -45,13 +47,13 @@ public:
             return;
 
         for (int i = step; i < len; i++) {
-            T tmp = arr[i];
+            T tmp = std::move(arr[i]);
             int j = i - step;
             while (j >= 0 && (tmp < arr[j])) {
-                arr[j] = arr[j + step];
+                arr[j + step] = std::move(arr[j]);
                 j -= step;
             }
-            arr[j + step] = tmp;
+            arr[j + step] = std::move(tmp);
         }
         shellSortRecursive(arr, len, step / 3);
     }
@@ -62,13 +64,13 @@ public:
             step = step * 3 + 1;
         while (step >= 1) {
             for (int i = step; i < len; i++) {
-                T tmp = arr[i];
+                T tmp = std::move(arr[i]);
                 int j = i - step;
                 while (j >= 0 && (tmp < arr[j])) {
-                    arr[j] = arr[j + step];
+                    arr[j + step] = std::move(arr[j]);
                     j -= step;
                 }
-                arr[j + step] = tmp;
+                arr[j + step] = std::move(tmp);
             }
             step = step / 3;
         }
@@ -76,9 +78,9 @@ public:
 
 private:
     void swap(T *arr, const int i, const int j) {
-        T k = arr[i];
-        arr[i] = arr[j];
-        arr[j] = k;
+        T k = std::move(arr[i]);
+        arr[i] = std::move(arr[j]);
+        arr[j] = std::move(k);
     }
 
     bool isSorted(T *arr, const int lo, const int hi) {
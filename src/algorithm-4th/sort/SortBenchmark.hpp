@@ -0,0 +1,470 @@
+#ifndef SORTBENCHMARK_HPP
+#define SORTBENCHMARK_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PerfCounters.hpp"
+#include "SortUtil.hpp"
+
+/*
+ 排序算法的基准测试
+   - 每个算法单独跑，先跑warmup次预热，再跑repetitions次计时，每次都从同一份输入的拷贝开始，
+     排完检查结果是否有序，并用校验和检查结果是不是输入的一个排列；
+   - 输入分布和规模都可以配置，同一组(分布, 规模)下所有算法用的是同一份输入；
+   - 报告计时的中位数、p95、最小值和每秒排序的元素个数；
+   - 另外用Counted<T>包装元素单独跑一次(不计时)，统计比较次数和元素移动(拷贝/移动构造和赋值)次数；
+   - perfCounters打开时，计时的每一次同时用PerfCounters统计硬件计数器，报告每次排序的平均值；
+   - 结果可以输出成CSV或JSON。
+ */
+
+//Counted<T>的计数器，并行排序时多个线程一起累加
+struct OperationCount {
+    static std::atomic<long long> &comparisons() {
+        static std::atomic<long long> count(0);
+        return count;
+    }
+
+    static std::atomic<long long> &moves() {
+        static std::atomic<long long> count(0);
+        return count;
+    }
+
+    static void reset() {
+        comparisons() = 0;
+        moves() = 0;
+    }
+};
+
+//包装一个元素，每次比较、每次拷贝或移动都记一次数
+template<typename T>
+class Counted {
+public:
+    Counted() : value() {}
+
+    explicit Counted(const T &value) : value(value) {}
+
+    Counted(const Counted &that) : value(that.value) {
+        countMove();
+    }
+
+    Counted(Counted &&that) : value(std::move(that.value)) {
+        countMove();
+    }
+
+    Counted &operator=(const Counted &that) {
+        value = that.value;
+        countMove();
+        return *this;
+    }
+
+    Counted &operator=(Counted &&that) {
+        value = std::move(that.value);
+        countMove();
+        return *this;
+    }
+
+    bool operator<(const Counted &that) const {
+        countComparison();
+        return value < that.value;
+    }
+
+    bool operator>(const Counted &that) const {
+        countComparison();
+        return that.value < value;
+    }
+
+    bool operator<=(const Counted &that) const {
+        countComparison();
+        return !(that.value < value);
+    }
+
+    bool operator>=(const Counted &that) const {
+        countComparison();
+        return !(value < that.value);
+    }
+
+    bool operator==(const Counted &that) const {
+        countComparison();
+        return value == that.value;
+    }
+
+    bool operator!=(const Counted &that) const {
+        countComparison();
+        return !(value == that.value);
+    }
+
+    const T &get() const { return value; }
+
+private:
+    T value;
+
+    static void countComparison() {
+        OperationCount::comparisons().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void countMove() {
+        OperationCount::moves().fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+enum InputDistribution {
+    RANDOM_INPUT,       //[0, INT_MAX]上均匀分布
+    SORTED_INPUT,       //升序
+    REVERSED_INPUT,     //降序
+    NEARLY_SORTED_INPUT,//升序之后随机交换1%的位置
+    FEW_UNIQUE_INPUT,   //只有16种不同的值
+    ZIPF_INPUT          //Zipf分布(s=1)，少数几个值占了大部分
+};
+
+inline const char *distributionName(const InputDistribution dist) {
+    switch (dist) {
+        case RANDOM_INPUT:
+            return "random";
+        case SORTED_INPUT:
+            return "sorted";
+        case REVERSED_INPUT:
+            return "reversed";
+        case NEARLY_SORTED_INPUT:
+            return "nearly_sorted";
+        case FEW_UNIQUE_INPUT:
+            return "few_unique";
+        case ZIPF_INPUT:
+            return "zipf";
+    }
+    return "unknown";
+}
+
+//按名字找分布，找不到返回false
+inline bool parseDistribution(const std::string &name, InputDistribution &dist) {
+    const InputDistribution all[] = {RANDOM_INPUT, SORTED_INPUT, REVERSED_INPUT,
+                                     NEARLY_SORTED_INPUT, FEW_UNIQUE_INPUT, ZIPF_INPUT};
+    for (InputDistribution d : all) {
+        if (name == distributionName(d)) {
+            dist = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+//生成num个非负整数键
+inline std::vector<long long> generateKeys(const InputDistribution dist, const int num, const unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<long long> keys(num);
+    switch (dist) {
+        case RANDOM_INPUT: {
+            std::uniform_int_distribution<long long> pick(0, INT_MAX);
+            for (int i = 0; i < num; i++)
+                keys[i] = pick(rng);
+            break;
+        }
+        case SORTED_INPUT:
+            for (int i = 0; i < num; i++)
+                keys[i] = i;
+            break;
+        case REVERSED_INPUT:
+            for (int i = 0; i < num; i++)
+                keys[i] = num - i;
+            break;
+        case NEARLY_SORTED_INPUT: {
+            for (int i = 0; i < num; i++)
+                keys[i] = i;
+            if (num > 0) {
+                std::uniform_int_distribution<int> pick(0, num - 1);
+                for (int i = 0; i < num / 100; i++)
+                    std::swap(keys[pick(rng)], keys[pick(rng)]);
+            }
+            break;
+        }
+        case FEW_UNIQUE_INPUT: {
+            std::uniform_int_distribution<long long> pick(0, 15);
+            for (int i = 0; i < num; i++)
+                keys[i] = pick(rng);
+            break;
+        }
+        case ZIPF_INPUT: {
+            //第r个值出现的概率正比于1/r，累积分布上二分查找
+            int ranks = std::max(1, std::min(num, 1 << 20));
+            std::vector<double> cdf(ranks);
+            double sum = 0;
+            for (int r = 0; r < ranks; r++) {
+                sum += 1.0 / (r + 1);
+                cdf[r] = sum;
+            }
+            std::uniform_real_distribution<double> pick(0, sum);
+            for (int i = 0; i < num; i++)
+                keys[i] = std::lower_bound(cdf.begin(), cdf.end(), pick(rng)) - cdf.begin();
+            break;
+        }
+    }
+    return keys;
+}
+
+//把整数键变成要排序的元素，自定义的元素类型特化这个模板
+template<typename T>
+struct BenchmarkValue {
+    static T from(const long long key) {
+        return static_cast<T>(key);
+    }
+};
+
+template<>
+struct BenchmarkValue<std::string> {
+    //定长补零，字符串的顺序和整数的顺序一致
+    static std::string from(const long long key) {
+        char buf[24];
+        snprintf(buf, sizeof(buf), "%019lld", key);
+        return buf;
+    }
+};
+
+template<typename T>
+struct BenchmarkValue<Counted<T> > {
+    static Counted<T> from(const long long key) {
+        return Counted<T>(BenchmarkValue<T>::from(key));
+    }
+};
+
+struct BenchmarkConfig {
+    std::vector<int> sizes;
+    std::vector<InputDistribution> distributions;
+    int warmup = 1;
+    int repetitions = 5;
+    bool countOperations = true;
+    bool perfCounters = false;
+    unsigned seed = 20210223;
+};
+
+struct BenchmarkResult {
+    std::string algorithm;
+    std::string distribution;
+    int size;
+    int repetitions;
+    double medianMs;
+    double p95Ms;
+    double minMs;
+    double elementsPerSec;
+    long long comparisons;  //没有统计时是-1
+    long long moves;
+    bool sorted;            //每次计时的结果是否都有序
+    bool permutation;       //每次的结果是否都和输入的校验和一致
+    PerfSample perf;        //每次排序的平均硬件计数，没有统计时各项是-1
+};
+
+template<typename T>
+class SortBenchmark {
+public:
+    typedef std::function<void(T *, int)> SortFunction;
+    typedef std::function<void(Counted<T> *, int)> CountedSortFunction;
+
+    //counted为空时不统计比较和移动次数；规模超过maxSize时跳过这个算法(比如O(n^2)的排序)
+    void add(const std::string &name, const SortFunction &sort,
+             const CountedSortFunction &counted = CountedSortFunction(), const int maxSize = INT_MAX) {
+        Algorithm algorithm;
+        algorithm.name = name;
+        algorithm.sort = sort;
+        algorithm.counted = counted;
+        algorithm.maxSize = maxSize;
+        algorithms.push_back(algorithm);
+    }
+
+    //登记一个排序类的sortIterative/sortRecursive/sortAdvanced，CountedSort是同一个类作用在Counted<T>上
+    template<typename Sort, typename CountedSort>
+    void addSortClass(const std::string &name, const int maxSize = INT_MAX) {
+        add(name + "::sortIterative",
+            [](T *arr, int len) { Sort().sortIterative(arr, len); },
+            [](Counted<T> *arr, int len) { CountedSort().sortIterative(arr, len); }, maxSize);
+        add(name + "::sortRecursive",
+            [](T *arr, int len) { Sort().sortRecursive(arr, len); },
+            [](Counted<T> *arr, int len) { CountedSort().sortRecursive(arr, len); }, maxSize);
+        add(name + "::sortAdvanced",
+            [](T *arr, int len) { Sort().sortAdvanced(arr, len); },
+            [](Counted<T> *arr, int len) { CountedSort().sortAdvanced(arr, len); }, maxSize);
+    }
+
+    //只能作用在T上的排序类(比如基数排序)，不统计比较和移动次数
+    template<typename Sort>
+    void addSortClass(const std::string &name, const int maxSize = INT_MAX) {
+        add(name + "::sortIterative", [](T *arr, int len) { Sort().sortIterative(arr, len); },
+            CountedSortFunction(), maxSize);
+        add(name + "::sortRecursive", [](T *arr, int len) { Sort().sortRecursive(arr, len); },
+            CountedSortFunction(), maxSize);
+        add(name + "::sortAdvanced", [](T *arr, int len) { Sort().sortAdvanced(arr, len); },
+            CountedSortFunction(), maxSize);
+    }
+
+    //依次跑所有(规模, 分布, 算法)，progress不为空时每跑完一个输出一行进度
+    std::vector<BenchmarkResult> run(const BenchmarkConfig &config, std::ostream *progress = nullptr) {
+        std::vector<BenchmarkResult> results;
+        for (int size : config.sizes) {
+            for (InputDistribution dist : config.distributions) {
+                std::vector<long long> keys = generateKeys(dist, size, config.seed);
+                std::vector<T> input = convert<T>(keys);
+                for (const Algorithm &algorithm : algorithms) {
+                    if (size > algorithm.maxSize)
+                        continue;
+                    BenchmarkResult result = measure(algorithm, input, config);
+                    result.distribution = distributionName(dist);
+                    if (config.countOperations && algorithm.counted) {
+                        std::vector<Counted<T> > counted = convert<Counted<T> >(keys);
+                        OperationCount::reset();
+                        algorithm.counted(counted.data(), size);
+                        result.comparisons = OperationCount::comparisons();
+                        result.moves = OperationCount::moves();
+                    }
+                    if (progress)
+                        *progress << result.algorithm << " " << result.distribution << " n=" << size
+                                  << " median=" << result.medianMs << "ms"
+                                  << (result.perf.valid() ? " ipc=" + std::to_string(result.perf.ipc()) : "")
+                                  << (result.sorted ? "" : " NOT SORTED")
+                                  << (result.permutation ? "" : " NOT A PERMUTATION") << std::endl;
+                    results.push_back(result);
+                }
+            }
+        }
+        return results;
+    }
+
+    static void writeCsv(std::ostream &out, const std::vector<BenchmarkResult> &results) {
+        out << "algorithm,distribution,size,repetitions,median_ms,p95_ms,min_ms,elements_per_sec,"
+               "comparisons,moves,sorted,permutation";
+        for (int e = 0; e < PERF_EVENT_COUNT; e++)
+            out << ',' << perfEventName(e);
+        out << ",ipc\n";
+        for (const BenchmarkResult &r : results) {
+            out << csvField(r.algorithm) << ',' << r.distribution << ',' << r.size << ',' << r.repetitions << ','
+                << r.medianMs << ',' << r.p95Ms << ',' << r.minMs << ',' << std::fixed << std::setprecision(0)
+                << r.elementsPerSec << std::defaultfloat << std::setprecision(6) << ','
+                << r.comparisons << ',' << r.moves << ',' << (r.sorted ? "true" : "false") << ','
+                << (r.permutation ? "true" : "false");
+            for (int e = 0; e < PERF_EVENT_COUNT; e++)
+                out << ',' << r.perf[e];
+            out << ',' << r.perf.ipc() << '\n';
+        }
+    }
+
+    static void writeJson(std::ostream &out, const std::vector<BenchmarkResult> &results) {
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchmarkResult &r = results[i];
+            out << "  {\"algorithm\": " << jsonString(r.algorithm)
+                << ", \"distribution\": \"" << r.distribution << '"'
+                << ", \"size\": " << r.size
+                << ", \"repetitions\": " << r.repetitions
+                << ", \"median_ms\": " << r.medianMs
+                << ", \"p95_ms\": " << r.p95Ms
+                << ", \"min_ms\": " << r.minMs
+                << ", \"elements_per_sec\": " << std::fixed << std::setprecision(0) << r.elementsPerSec
+                << std::defaultfloat << std::setprecision(6)
+                << ", \"comparisons\": " << r.comparisons
+                << ", \"moves\": " << r.moves
+                << ", \"sorted\": " << (r.sorted ? "true" : "false")
+                << ", \"permutation\": " << (r.permutation ? "true" : "false");
+            for (int e = 0; e < PERF_EVENT_COUNT; e++)
+                out << ", \"" << perfEventName(e) << "\": " << r.perf[e];
+            out << ", \"ipc\": " << r.perf.ipc() << '}'
+                << (i + 1 < results.size() ? "," : "") << '\n';
+        }
+        out << "]\n";
+    }
+
+private:
+    struct Algorithm {
+        std::string name;
+        SortFunction sort;
+        CountedSortFunction counted;
+        int maxSize;
+    };
+
+    std::vector<Algorithm> algorithms;
+
+    template<typename V>
+    static std::vector<V> convert(const std::vector<long long> &keys) {
+        std::vector<V> values;
+        values.reserve(keys.size());
+        for (long long key : keys)
+            values.push_back(BenchmarkValue<V>::from(key));
+        return values;
+    }
+
+    //每次都从输入的拷贝开始排，拷贝、检查结果和打开计数器不计入时间
+    static BenchmarkResult measure(const Algorithm &algorithm, const std::vector<T> &input,
+                                   const BenchmarkConfig &config) {
+        BenchmarkResult result;
+        result.algorithm = algorithm.name;
+        result.size = (int) input.size();
+        result.repetitions = config.repetitions;
+        result.comparisons = -1;
+        result.moves = -1;
+        result.sorted = true;
+        result.permutation = true;
+        const int n = (int) input.size();
+        const uint64_t inputChecksum = SortUtil<T>::checksum(input.data(), n);
+        std::vector<T> arr = input;
+        std::vector<double> times;
+        PerfCounters counters;
+        PerfSample perfTotal;
+        for (int r = 0; r < config.warmup + config.repetitions; r++) {
+            if (r > 0)
+                SortUtil<T>::cloneArray(input.data(), arr.data(), n);
+            bool counting = config.perfCounters && r >= config.warmup && counters.start();
+            auto start = std::chrono::steady_clock::now();
+            algorithm.sort(arr.data(), n);
+            auto end = std::chrono::steady_clock::now();
+            if (counting)
+                perfTotal += counters.stop();
+            if (r >= config.warmup)
+                times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            if (!SortUtil<T>::isSorted(arr.data(), n))
+                result.sorted = false;
+            if (SortUtil<T>::checksum(arr.data(), n) != inputChecksum)
+                result.permutation = false;
+        }
+        std::sort(times.begin(), times.end());
+        if (times.empty())
+            times.push_back(0);
+        result.medianMs = times[(times.size() - 1) / 2];
+        result.p95Ms = times[std::max(0, (int) std::ceil(times.size() * 0.95) - 1)];
+        result.minMs = times[0];
+        result.elementsPerSec = result.medianMs > 0 ? result.size / (result.medianMs / 1000) : 0;
+        result.perf = perfTotal / config.repetitions;
+        return result;
+    }
+
+    static std::string csvField(const std::string &s) {
+        if (s.find_first_of(",\"\n") == std::string::npos)
+            return s;
+        std::string quoted = "\"";
+        for (char c : s) {
+            if (c == '"')
+                quoted += '"';
+            quoted += c;
+        }
+        return quoted + '"';
+    }
+
+    static std::string jsonString(const std::string &s) {
+        std::string quoted = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\')
+                quoted += '\\';
+            quoted += c;
+        }
+        return quoted + '"';
+    }
+};
+
+
+#endif //SORTBENCHMARK_HPP
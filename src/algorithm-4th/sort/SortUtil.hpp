@@ -0,0 +1,209 @@
+#ifndef SORTUTIL_HPP
+#define SORTUTIL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Partition.hpp"
+#include "WorkStealingPool.hpp"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+/*
+ 元素的哈希，用来算排序前后的校验和
+ 可以按字节拷贝的类型直接哈希它的字节，其他类型特化这个模板
+ */
+template<typename T, typename Enable = void>
+struct ElementHash {
+    static_assert(std::is_trivially_copyable<T>::value, "specialize ElementHash for this type");
+
+    uint64_t operator()(const T &x) const {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&x);
+        uint64_t h = 0x9e3779b97f4a7c15ull;
+        size_t i = 0;
+        for (; i + 8 <= sizeof(T); i += 8) {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            h = (h ^ word) * 0xff51afd7ed558ccdull;
+        }
+        if (i < sizeof(T)) {
+            uint64_t word = 0;
+            memcpy(&word, bytes + i, sizeof(T) - i);
+            h = (h ^ word) * 0xff51afd7ed558ccdull;
+        }
+        return h;
+    }
+};
+
+template<>
+struct ElementHash<std::string> {
+    uint64_t operator()(const std::string &s) const {
+        return std::hash<std::string>()(s);
+    }
+};
+
+namespace sort_util_simd {
+
+    //没有向量实现的类型和比较函数
+    template<typename T, typename Compare, typename Enable = void>
+    struct Dispatch {
+        static bool isSorted(const T *, const int, bool &) { return false; }
+    };
+
+#if SORTING_NETWORK_X86
+
+    /*
+     a = arr[i, i+W)，b = arr[i+1, i+1+W)，a > b的位不为0就说明有逆序的相邻对
+     一次看4个向量，把掩码或起来再判断，循环里只有一个分支
+     */
+    template<typename Ops>
+    __attribute__((target("avx2"))) __attribute__((flatten))
+    bool isSortedAvx2(const typename Ops::Elem *arr, const int n) {
+        typedef typename Ops::Elem Elem;
+        const int W = Ops::W;
+        int i = 0;
+        for (; i + 4 * W < n; i += 4 * W) {
+            int mask = 0;
+            for (int k = 0; k < 4; k++) {
+                const Elem *a = arr + i + k * W;
+                mask |= Ops::rightMask(Ops::load(a), Ops::load(a + 1), true);
+            }
+            if (mask)
+                return false;
+        }
+        for (; i + 1 < n; i++)
+            if (arr[i + 1] < arr[i])
+                return false;
+        return true;
+    }
+
+    template<typename T>
+    struct Dispatch<T, std::less<T>,
+            typename std::enable_if<!std::is_void<typename partition_simd::Avx2OpsOf<T>::type>::value>::type> {
+        typedef typename partition_simd::Avx2OpsOf<T>::type Ops;
+
+        static bool isSorted(const T *arr, const int n, bool &sorted) {
+            if (sortingNetworkIsa() < SORTING_NETWORK_AVX2)
+                return false;
+            sorted = isSortedAvx2<Ops>(arr, n);
+            return true;
+        }
+    };
+
+#endif //SORTING_NETWORK_X86
+}
+
+#pragma GCC diagnostic pop
+
+/*
+ 排序结果的检查和数组拷贝，给各个基准测试的驱动程序共用，几千万个元素时检查本身也要花不少时间：
+   - isSorted: int/float/int64_t/double用std::less比较时用AVX2一次比较一个向量，
+     大数组切成线程池线程数份并行检查，相邻两份重叠一个元素，一份发现逆序其他份尽早停下；
+   - checksum: 每个元素的哈希再混合一次后相加，和元素的顺序无关，排序前后相等说明输出是输入的一个排列
+     (不相等一定不是)，也可以并行地分段求和；
+   - cloneArray: 并行地分段拷贝。
+ */
+template<typename T>
+class SortUtil {
+public:
+    template<typename Compare = std::less<T> >
+    static bool isSorted(const T *arr, const int len, Compare comp = Compare()) {
+        const int parts = partsOf(len);
+        if (parts <= 1)
+            return isSortedRange(arr, len, comp);
+        std::atomic<bool> sorted(true);
+        TaskGroup group;
+        for (int p = 0; p < parts; p++) {
+            const int begin = (int) ((long long) len * p / parts);
+            const int end = (int) std::min<long long>((long long) len * (p + 1) / parts + 1, len);
+            group.run([arr, begin, end, comp, &sorted]() {
+                for (int lo = begin; lo < end - 1 && sorted.load(std::memory_order_relaxed); lo += CHUNK) {
+                    int hi = std::min(lo + CHUNK + 1, end);
+                    if (!isSortedRange(arr + lo, hi - lo, comp))
+                        sorted.store(false, std::memory_order_relaxed);
+                }
+            });
+        }
+        group.wait();
+        return sorted.load();
+    }
+
+    //一个元素对校验和的贡献，数据不在一个数组里(比如外部排序的文件)时逐个累加
+    static uint64_t checksumOf(const T &x) {
+        //splitmix64的混合函数，让相加之前每一位都均匀
+        uint64_t z = ElementHash<T>()(x) + 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    static uint64_t checksum(const T *arr, const int len) {
+        const int parts = partsOf(len);
+        std::vector<uint64_t> sums(std::max(parts, 1), 0);
+        forEachPart(len, parts, [arr, &sums](int p, int begin, int end) {
+            uint64_t sum = 0;
+            for (int i = begin; i < end; i++)
+                sum += checksumOf(arr[i]);
+            sums[p] = sum;
+        });
+        uint64_t sum = 0;
+        for (uint64_t s : sums)
+            sum += s;
+        return sum;
+    }
+
+    //dst[0, len) = src[0, len)，dst要已经有len个元素
+    static void cloneArray(const T *src, T *dst, const int len) {
+        forEachPart(len, partsOf(len), [src, dst](int, int begin, int end) {
+            std::copy(src + begin, src + end, dst + begin);
+        });
+    }
+
+private:
+    static const int PARALLEL_MIN_LENGTH = 1 << 18;
+    //并行检查时每检查这么多个元素看一眼别的线程有没有发现逆序
+    static const int CHUNK = 1 << 14;
+
+    static int partsOf(const int len) {
+        if (len < PARALLEL_MIN_LENGTH)
+            return 1;
+        return (int) std::min<long long>(WorkStealingPool::instance().size(), len / (PARALLEL_MIN_LENGTH / 4));
+    }
+
+    //把[0, len)切成parts份，每份交给线程池执行f(p, begin, end)
+    template<typename F>
+    static void forEachPart(const int len, const int parts, const F &f) {
+        if (parts <= 1) {
+            f(0, 0, len);
+            return;
+        }
+        TaskGroup group;
+        for (int p = 0; p < parts; p++) {
+            const int begin = (int) ((long long) len * p / parts);
+            const int end = (int) ((long long) len * (p + 1) / parts);
+            group.run([&f, p, begin, end]() { f(p, begin, end); });
+        }
+        group.wait();
+    }
+
+    template<typename Compare>
+    static bool isSortedRange(const T *arr, const int n, Compare comp) {
+        bool sorted;
+        if (sort_util_simd::Dispatch<T, Compare>::isSorted(arr, n, sorted))
+            return sorted;
+        for (int i = 0; i + 1 < n; i++)
+            if (comp(arr[i + 1], arr[i]))
+                return false;
+        return true;
+    }
+};
+
+
+#endif //SORTUTIL_HPP
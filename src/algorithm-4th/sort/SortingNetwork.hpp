@@ -0,0 +1,526 @@
+#ifndef SORTINGNETWORK_HPP
+#define SORTINGNETWORK_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SORTING_NETWORK_X86 1
+#include <immintrin.h>
+#else
+#define SORTING_NETWORK_X86 0
+#endif
+
+/*
+ SIMD排序网络，作为QuickSort/MergeSort小区间的基本情况
+ 一个块是W个向量寄存器，每个寄存器W个元素(AVX2下int/float是8x8=64个，int64_t/double是4x4=16个，SSE4.1下int/float是4x4=16个)：
+   1. 对W个寄存器做一遍排序网络，只用向量的min/max，W列同时排好；
+   2. 转置，每个寄存器变成一个有序的序列；
+   3. 用双调(bitonic)归并两两合并寄存器，直到整个块有序。
+ 不足一个块的部分用类型的最大值填充，排序后只写回前n个。
+ float/double不直接用min_ps/max_ps：两个数相等(-0.0和+0.0)或者有NaN时它们都返回第二个操作数，
+ 一个值被输出两次、另一个丢了。载入时把位模式换成有符号整数键(负数翻转除符号位以外的位)，
+ 整个网络用整数的min/max，写回时再换回来：键是全序，-0.0排在+0.0前面，NaN排在两端，
+ 每次比较交换的两个输出一定是两个输入，结果总是输入的一个排列。
+ 另外提供向量化的二路归并：每次把下一段W个元素和手上的W个元素做一次寄存器内的双调归并，输出较小的W个。
+ CPU支持哪个指令集在运行时检测，整个程序仍然按基础的x86-64编译；不支持的类型或CPU返回false，调用方走原来的标量代码。
+ */
+enum SortingNetworkIsa {
+    SORTING_NETWORK_SCALAR = 0,
+    SORTING_NETWORK_SSE41 = 1,
+    SORTING_NETWORK_AVX2 = 2
+};
+
+//当前使用的指令集，第一次调用时检测CPU，测试时可以改小来走低一级的实现
+inline SortingNetworkIsa &sortingNetworkIsa() {
+    static SortingNetworkIsa isa = []() {
+#if SORTING_NETWORK_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return SORTING_NETWORK_AVX2;
+        if (__builtin_cpu_supports("sse4.1"))
+            return SORTING_NETWORK_SSE41;
+#endif
+        return SORTING_NETWORK_SCALAR;
+    }();
+    return isa;
+}
+
+//Kernel本身不带target属性，只在入口函数里被整个内联，向量参数不会真的按非AVX的ABI传递
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace sorting_network {
+
+    template<typename E>
+    inline E sentinel() {
+        return std::numeric_limits<E>::max();
+    }
+
+    //浮点数的填充值要是最大的键：正的NaN，所有位都是1，比+inf和输入里的NaN都大
+    template<>
+    inline float sentinel<float>() {
+        const uint32_t bits = 0x7FFFFFFFu;
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    template<>
+    inline double sentinel<double>() {
+        const uint64_t bits = 0x7FFFFFFFFFFFFFFFull;
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+
+    template<typename E>
+    void mergeScalar(const E *a, const E *aEnd, const E *b, const E *bEnd, E *out) {
+        while (a != aEnd && b != bEnd)
+            *out++ = *b < *a ? *b++ : *a++;
+        while (a != aEnd)
+            *out++ = *a++;
+        while (b != bEnd)
+            *out++ = *b++;
+    }
+
+    template<typename E>
+    void merge3Scalar(const E *a, const E *aEnd, const E *b, const E *bEnd, const E *c, const E *cEnd, E *out) {
+        while (a != aEnd && b != bEnd && c != cEnd) {
+            if (*b < *a)
+                *out++ = *c < *b ? *c++ : *b++;
+            else
+                *out++ = *c < *a ? *c++ : *a++;
+        }
+        if (a == aEnd)
+            mergeScalar(b, bEnd, c, cEnd, out);
+        else if (b == bEnd)
+            mergeScalar(a, aEnd, c, cEnd, out);
+        else
+            mergeScalar(a, aEnd, b, bEnd, out);
+    }
+
+    /*
+     和指令集无关的排序网络，Ops提供某个指令集上某种元素的向量操作：
+     load/store/vmin/vmax、reverse(寄存器内逆序)、clean(寄存器内的双调序列排好序)、transpose(WxW转置)
+     */
+    template<typename Ops>
+    struct Kernel {
+        typedef typename Ops::Elem E;
+        typedef typename Ops::Vec V;
+        static const int W = Ops::W;
+        static const int N = W * W;
+
+        static void compareExchange(V &a, V &b) {
+            V t = Ops::vmin(a, b);
+            b = Ops::vmax(a, b);
+            a = t;
+        }
+
+        //对W个寄存器的每一列排序
+        static void sortColumns(V *r) {
+            if (W == 8) {
+                compareExchange(r[0], r[2]); compareExchange(r[1], r[3]);
+                compareExchange(r[4], r[6]); compareExchange(r[5], r[7]);
+                compareExchange(r[0], r[4]); compareExchange(r[1], r[5]);
+                compareExchange(r[2], r[6]); compareExchange(r[3], r[7]);
+                compareExchange(r[0], r[1]); compareExchange(r[2], r[3]);
+                compareExchange(r[4], r[5]); compareExchange(r[6], r[7]);
+                compareExchange(r[2], r[4]); compareExchange(r[3], r[5]);
+                compareExchange(r[1], r[4]); compareExchange(r[3], r[6]);
+                compareExchange(r[1], r[2]); compareExchange(r[3], r[4]); compareExchange(r[5], r[6]);
+            } else {
+                compareExchange(r[0], r[1]); compareExchange(r[2], r[3]);
+                compareExchange(r[0], r[2]); compareExchange(r[1], r[3]);
+                compareExchange(r[1], r[2]);
+            }
+        }
+
+        //r[0, m/2)和r[m/2, m)各是一个有序序列，合并成r[0, m)
+        static void mergeRegisters(V *r, const int m) {
+            //后一半整体逆序，两段拼起来是一个双调序列
+            for (int i = m / 2, j = m - 1; i < j; i++, j--) {
+                V t = r[i];
+                r[i] = r[j];
+                r[j] = t;
+            }
+            for (int i = m / 2; i < m; i++)
+                r[i] = Ops::reverse(r[i]);
+            for (int d = m / 2; d >= 1; d >>= 1)
+                for (int i = 0; i < m; i++)
+                    if ((i & d) == 0)
+                        compareExchange(r[i], r[i + d]);
+            for (int i = 0; i < m; i++)
+                r[i] = Ops::clean(r[i]);
+        }
+
+        static void sortBlock(E *arr, const int n) {
+            E buf[N];
+            memcpy(buf, arr, n * sizeof(E));
+            for (int i = n; i < N; i++)
+                buf[i] = sentinel<E>();
+            V r[W];
+            for (int i = 0; i < W; i++)
+                r[i] = Ops::load(buf + i * W);
+            sortColumns(r);
+            Ops::transpose(r);
+            for (int m = 2; m <= W; m <<= 1)
+                for (int i = 0; i < W; i += m)
+                    mergeRegisters(r + i, m);
+            for (int i = 0; i < W; i++)
+                Ops::store(buf + i * W, r[i]);
+            memcpy(arr, buf, n * sizeof(E));
+        }
+
+        //lo和hi各是一个有序的寄存器，合并后lo是较小的W个，hi是较大的W个
+        static void merge2(V &lo, V &hi) {
+            V b = Ops::reverse(hi);
+            V l = Ops::vmin(lo, b);
+            V h = Ops::vmax(lo, b);
+            lo = Ops::clean(l);
+            hi = Ops::clean(h);
+        }
+
+        static void merge(const E *a, const int na, const E *b, const int nb, E *out) {
+            const E *aEnd = a + na, *bEnd = b + nb;
+            if (na < W || nb < W) {
+                mergeScalar(a, aEnd, b, bEnd, out);
+                return;
+            }
+            V lo = Ops::load(a), hi = Ops::load(b);
+            a += W;
+            b += W;
+            merge2(lo, hi);
+            Ops::store(out, lo);
+            out += W;
+            //hi里是已经读入但还没输出的W个元素，下一段从队头较小的那个序列读，保证输出的lo不大于所有没读入的元素
+            while (true) {
+                bool takeA = b == bEnd || (a != aEnd && !(*b < *a));
+                const E *&src = takeA ? a : b;
+                if ((takeA ? aEnd : bEnd) - src < W)
+                    break;
+                lo = Ops::load(src);
+                src += W;
+                merge2(lo, hi);
+                Ops::store(out, lo);
+                out += W;
+            }
+            E rest[W];
+            Ops::store(rest, hi);
+            merge3Scalar(rest, rest + W, a, aEnd, b, bEnd, out);
+        }
+    };
+
+#if SORTING_NETWORK_X86
+
+#define SORTING_NETWORK_TARGET_AVX2 __attribute__((target("avx2")))
+#define SORTING_NETWORK_TARGET_SSE41 __attribute__((target("sse4.1")))
+
+    struct Avx2Int32 {
+        typedef int Elem;
+        typedef __m256i Vec;
+        static const int W = 8;
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec load(const int *p) { return _mm256_loadu_si256((const __m256i *) p); }
+
+        SORTING_NETWORK_TARGET_AVX2 static void store(int *p, Vec v) { _mm256_storeu_si256((__m256i *) p, v); }
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec vmin(Vec a, Vec b) { return _mm256_min_epi32(a, b); }
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec vmax(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec reverse(Vec v) {
+            return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+        }
+
+        //距离4、2、1的元素依次比较，较小的留在低位
+        SORTING_NETWORK_TARGET_AVX2 static Vec clean(Vec v) {
+            Vec s = _mm256_permute2x128_si256(v, v, 0x01);
+            v = _mm256_blend_epi32(vmin(v, s), vmax(v, s), 0xF0);
+            s = _mm256_shuffle_epi32(v, 0x4E);
+            v = _mm256_blend_epi32(vmin(v, s), vmax(v, s), 0xCC);
+            s = _mm256_shuffle_epi32(v, 0xB1);
+            return _mm256_blend_epi32(vmin(v, s), vmax(v, s), 0xAA);
+        }
+
+        SORTING_NETWORK_TARGET_AVX2 static void transpose(Vec *r) {
+            Vec t0 = _mm256_unpacklo_epi32(r[0], r[1]), t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+            Vec t2 = _mm256_unpacklo_epi32(r[2], r[3]), t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+            Vec t4 = _mm256_unpacklo_epi32(r[4], r[5]), t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+            Vec t6 = _mm256_unpacklo_epi32(r[6], r[7]), t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+            Vec u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+            Vec u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+            Vec u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+            Vec u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+            r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+            r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+            r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+            r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+            r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+            r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+            r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+            r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+        }
+    };
+
+    //浮点数在寄存器里是整数键，比较交换都用Avx2Int32的，只有载入和写回时转换(这个转换自己是自己的逆)
+    struct Avx2Float : Avx2Int32 {
+        typedef float Elem;
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec toKey(Vec v) {
+            return _mm256_xor_si256(v, _mm256_srli_epi32(_mm256_srai_epi32(v, 31), 1));
+        }
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec load(const float *p) {
+            return toKey(_mm256_loadu_si256((const __m256i *) p));
+        }
+
+        SORTING_NETWORK_TARGET_AVX2 static void store(float *p, Vec v) {
+            _mm256_storeu_si256((__m256i *) p, toKey(v));
+        }
+    };
+
+    struct Avx2Int64 {
+        typedef int64_t Elem;
+        typedef __m256i Vec;
+        static const int W = 4;
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec load(const int64_t *p) { return _mm256_loadu_si256((const __m256i *) p); }
+
+        SORTING_NETWORK_TARGET_AVX2 static void store(int64_t *p, Vec v) { _mm256_storeu_si256((__m256i *) p, v); }
+
+        //AVX2没有64位整数的min/max，用比较+混合
+        SORTING_NETWORK_TARGET_AVX2 static Vec vmin(Vec a, Vec b) {
+            return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+        }
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec vmax(Vec a, Vec b) {
+            return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+        }
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec reverse(Vec v) { return _mm256_permute4x64_epi64(v, 0x1B); }
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec clean(Vec v) {
+            Vec s = _mm256_permute4x64_epi64(v, 0x4E);
+            v = _mm256_blend_epi32(vmin(v, s), vmax(v, s), 0xF0);
+            s = _mm256_permute4x64_epi64(v, 0xB1);
+            return _mm256_blend_epi32(vmin(v, s), vmax(v, s), 0xCC);
+        }
+
+        SORTING_NETWORK_TARGET_AVX2 static void transpose(Vec *r) {
+            Vec t0 = _mm256_unpacklo_epi64(r[0], r[1]), t1 = _mm256_unpackhi_epi64(r[0], r[1]);
+            Vec t2 = _mm256_unpacklo_epi64(r[2], r[3]), t3 = _mm256_unpackhi_epi64(r[2], r[3]);
+            r[0] = _mm256_permute2x128_si256(t0, t2, 0x20);
+            r[1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+            r[2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+            r[3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+        }
+    };
+
+    struct Avx2Double : Avx2Int64 {
+        typedef double Elem;
+
+        //AVX2没有64位的算术右移，符号位用和0比较得到
+        SORTING_NETWORK_TARGET_AVX2 static Vec toKey(Vec v) {
+            return _mm256_xor_si256(v, _mm256_srli_epi64(_mm256_cmpgt_epi64(_mm256_setzero_si256(), v), 1));
+        }
+
+        SORTING_NETWORK_TARGET_AVX2 static Vec load(const double *p) {
+            return toKey(_mm256_loadu_si256((const __m256i *) p));
+        }
+
+        SORTING_NETWORK_TARGET_AVX2 static void store(double *p, Vec v) {
+            _mm256_storeu_si256((__m256i *) p, toKey(v));
+        }
+    };
+
+    struct Sse41Int32 {
+        typedef int Elem;
+        typedef __m128i Vec;
+        static const int W = 4;
+
+        SORTING_NETWORK_TARGET_SSE41 static Vec load(const int *p) { return _mm_loadu_si128((const __m128i *) p); }
+
+        SORTING_NETWORK_TARGET_SSE41 static void store(int *p, Vec v) { _mm_storeu_si128((__m128i *) p, v); }
+
+        SORTING_NETWORK_TARGET_SSE41 static Vec vmin(Vec a, Vec b) { return _mm_min_epi32(a, b); }
+
+        SORTING_NETWORK_TARGET_SSE41 static Vec vmax(Vec a, Vec b) { return _mm_max_epi32(a, b); }
+
+        SORTING_NETWORK_TARGET_SSE41 static Vec reverse(Vec v) { return _mm_shuffle_epi32(v, 0x1B); }
+
+        SORTING_NETWORK_TARGET_SSE41 static Vec clean(Vec v) {
+            Vec s = _mm_shuffle_epi32(v, 0x4E);
+            v = _mm_blend_epi16(vmin(v, s), vmax(v, s), 0xF0);
+            s = _mm_shuffle_epi32(v, 0xB1);
+            return _mm_blend_epi16(vmin(v, s), vmax(v, s), 0xCC);
+        }
+
+        SORTING_NETWORK_TARGET_SSE41 static void transpose(Vec *r) {
+            Vec t0 = _mm_unpacklo_epi32(r[0], r[1]), t1 = _mm_unpackhi_epi32(r[0], r[1]);
+            Vec t2 = _mm_unpacklo_epi32(r[2], r[3]), t3 = _mm_unpackhi_epi32(r[2], r[3]);
+            r[0] = _mm_unpacklo_epi64(t0, t2);
+            r[1] = _mm_unpackhi_epi64(t0, t2);
+            r[2] = _mm_unpacklo_epi64(t1, t3);
+            r[3] = _mm_unpackhi_epi64(t1, t3);
+        }
+    };
+
+    struct Sse41Float : Sse41Int32 {
+        typedef float Elem;
+
+        SORTING_NETWORK_TARGET_SSE41 static Vec toKey(Vec v) {
+            return _mm_xor_si128(v, _mm_srli_epi32(_mm_srai_epi32(v, 31), 1));
+        }
+
+        SORTING_NETWORK_TARGET_SSE41 static Vec load(const float *p) {
+            return toKey(_mm_loadu_si128((const __m128i *) p));
+        }
+
+        SORTING_NETWORK_TARGET_SSE41 static void store(float *p, Vec v) {
+            _mm_storeu_si128((__m128i *) p, toKey(v));
+        }
+    };
+
+    /*
+     每个指令集一组入口函数，带上target属性，flatten把Kernel和Ops全部内联进来，
+     这样Kernel不用为每个指令集写一遍，生成的代码里也没有函数调用
+     */
+    template<typename Ops>
+    SORTING_NETWORK_TARGET_AVX2 __attribute__((flatten)) void sortBlockAvx2(typename Ops::Elem *arr, const int n) {
+        Kernel<Ops>::sortBlock(arr, n);
+    }
+
+    template<typename Ops>
+    SORTING_NETWORK_TARGET_AVX2 __attribute__((flatten))
+    void mergeAvx2(const typename Ops::Elem *a, const int na, const typename Ops::Elem *b, const int nb,
+                   typename Ops::Elem *out) {
+        Kernel<Ops>::merge(a, na, b, nb, out);
+    }
+
+    template<typename Ops>
+    SORTING_NETWORK_TARGET_SSE41 __attribute__((flatten)) void sortBlockSse41(typename Ops::Elem *arr, const int n) {
+        Kernel<Ops>::sortBlock(arr, n);
+    }
+
+    template<typename Ops>
+    SORTING_NETWORK_TARGET_SSE41 __attribute__((flatten))
+    void mergeSse41(const typename Ops::Elem *a, const int na, const typename Ops::Elem *b, const int nb,
+                    typename Ops::Elem *out) {
+        Kernel<Ops>::merge(a, na, b, nb, out);
+    }
+
+#undef SORTING_NETWORK_TARGET_AVX2
+#undef SORTING_NETWORK_TARGET_SSE41
+
+    //按运行时检测到的指令集选择实现，Sse41Ops为void表示这个类型在SSE4.1下没有向量实现
+    template<typename T, typename Avx2Ops, typename Sse41Ops>
+    struct Dispatch {
+        static int maxLength() {
+            SortingNetworkIsa isa = sortingNetworkIsa();
+            if (isa >= SORTING_NETWORK_AVX2)
+                return Avx2Ops::W * Avx2Ops::W;
+            if (isa >= SORTING_NETWORK_SSE41)
+                return Sse41Width<Sse41Ops>::value;
+            return 0;
+        }
+
+        static bool sort(T *arr, const int len) {
+            SortingNetworkIsa isa = sortingNetworkIsa();
+            if (isa >= SORTING_NETWORK_AVX2 && len <= Avx2Ops::W * Avx2Ops::W) {
+                sortBlockAvx2<Avx2Ops>(arr, len);
+                return true;
+            }
+            if (isa >= SORTING_NETWORK_SSE41 && len <= Sse41Width<Sse41Ops>::value)
+                return Sse41Call<Sse41Ops>::sort(arr, len);
+            return false;
+        }
+
+        static bool merge(const T *a, const int na, const T *b, const int nb, T *out) {
+            SortingNetworkIsa isa = sortingNetworkIsa();
+            if (isa >= SORTING_NETWORK_AVX2) {
+                mergeAvx2<Avx2Ops>(a, na, b, nb, out);
+                return true;
+            }
+            if (isa >= SORTING_NETWORK_SSE41)
+                return Sse41Call<Sse41Ops>::merge(a, na, b, nb, out);
+            return false;
+        }
+
+    private:
+        template<typename Ops, typename Dummy = void>
+        struct Sse41Width {
+            static const int value = Ops::W * Ops::W;
+        };
+
+        template<typename Dummy>
+        struct Sse41Width<void, Dummy> {
+            static const int value = 0;
+        };
+
+        template<typename Ops, typename Dummy = void>
+        struct Sse41Call {
+            static bool sort(T *arr, const int len) {
+                sortBlockSse41<Ops>(arr, len);
+                return true;
+            }
+
+            static bool merge(const T *a, const int na, const T *b, const int nb, T *out) {
+                mergeSse41<Ops>(a, na, b, nb, out);
+                return true;
+            }
+        };
+
+        template<typename Dummy>
+        struct Sse41Call<void, Dummy> {
+            static bool sort(T *, const int) { return false; }
+
+            static bool merge(const T *, const int, const T *, const int, T *) { return false; }
+        };
+    };
+
+#endif //SORTING_NETWORK_X86
+}
+
+#pragma GCC diagnostic pop
+
+/*
+ 对外的接口：
+   maxLength(): 当前CPU上sort一次能排的最大长度，0表示这个类型没有向量实现；
+   sort(arr, len): len不超过maxLength()时排好序并返回true，否则什么也不做返回false；
+   merge(a, na, b, nb, out): 把两个有序数组归并到out(不能和输入重叠)，不支持时返回false。
+ */
+template<typename T>
+class SortingNetwork {
+public:
+    static int maxLength() { return 0; }
+
+    static bool sort(T *, const int) { return false; }
+
+    static bool merge(const T *, const int, const T *, const int, T *) { return false; }
+};
+
+#if SORTING_NETWORK_X86
+
+template<>
+class SortingNetwork<int>
+        : public sorting_network::Dispatch<int, sorting_network::Avx2Int32, sorting_network::Sse41Int32> {
+};
+
+template<>
+class SortingNetwork<float>
+        : public sorting_network::Dispatch<float, sorting_network::Avx2Float, sorting_network::Sse41Float> {
+};
+
+template<>
+class SortingNetwork<int64_t> : public sorting_network::Dispatch<int64_t, sorting_network::Avx2Int64, void> {
+};
+
+template<>
+class SortingNetwork<double> : public sorting_network::Dispatch<double, sorting_network::Avx2Double, void> {
+};
+
+#endif //SORTING_NETWORK_X86
+
+#endif //SORTINGNETWORK_HPP
@@ -0,0 +1,219 @@
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ 工作窃取线程池
+ 每个工作线程都有一个自己的双端队列：
+   - 自己提交的任务压到队尾，自己也从队尾取(LIFO)，刚拆分出来的子任务数据还在cache里；
+   - 空闲线程从别人队列的队头偷任务(FIFO)，分治算法里越早提交的任务越大，偷一次就能干很久。
+ 等待子任务的线程不会阻塞，而是通过runPendingTask()帮忙执行任务，递归分治不会把线程池锁死。
+ */
+class WorkStealingPool {
+public:
+    typedef std::function<void()> Task;
+
+    explicit WorkStealingPool(unsigned threadNum = 0) : stop(false), pending(0), next(0) {
+        if (threadNum == 0)
+            threadNum = std::thread::hardware_concurrency();
+        if (threadNum == 0)
+            threadNum = 1;
+        for (unsigned i = 0; i < threadNum; i++)
+            queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+        for (unsigned i = 0; i < threadNum; i++)
+            workers.push_back(std::thread(&WorkStealingPool::workerLoop, this, i));
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stop = true;
+        }
+        sleepCond.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    //进程内共享的线程池，线程数等于硬件线程数
+    static WorkStealingPool &instance() {
+        static WorkStealingPool pool;
+        return pool;
+    }
+
+    unsigned size() const { return (unsigned) workers.size(); }
+
+    void submit(Task task) {
+        int self = currentIndex();
+        unsigned q = self >= 0 ? (unsigned) self : (next++ % size());
+        {
+            std::lock_guard<std::mutex> lock(queues[q]->mutex);
+            queues[q]->tasks.push_back(std::move(task));
+        }
+        pending++;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        sleepCond.notify_one();
+    }
+
+    //执行一个待处理的任务，没有任务可做返回false
+    bool runPendingTask() {
+        Task task;
+        if (!popTask(task))
+            return false;
+        task();
+        return true;
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable sleepCond;
+    bool stop;
+    std::atomic<int> pending;   //所有队列中还没被取走的任务数
+    std::atomic<unsigned> next; //外部线程提交任务时轮流选择队列
+
+    //当前线程在本线程池中的编号，不是本线程池的工作线程返回-1
+    int currentIndex() const {
+        return currentPool() == this ? currentWorker() : -1;
+    }
+
+    static const WorkStealingPool *&currentPool() {
+        static thread_local const WorkStealingPool *pool = nullptr;
+        return pool;
+    }
+
+    static int &currentWorker() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    bool popTask(Task &task) {
+        if (pending.load() == 0)
+            return false;
+        int self = currentIndex();
+        //先从自己队列的尾部取
+        if (self >= 0) {
+            WorkQueue &own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                pending--;
+                return true;
+            }
+        }
+        //再去别人队列的头部偷
+        unsigned n = size();
+        unsigned start = self >= 0 ? (unsigned) self + 1 : next.load();
+        for (unsigned i = 0; i < n; i++) {
+            unsigned victim = (start + i) % n;
+            if ((int) victim == self)
+                continue;
+            WorkQueue &other = *queues[victim];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            if (!other.tasks.empty()) {
+                task = std::move(other.tasks.front());
+                other.tasks.pop_front();
+                pending--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(unsigned index) {
+        currentPool() = this;
+        currentWorker() = (int) index;
+        while (true) {
+            Task task;
+            if (popTask(task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCond.wait(lock, [this]() { return stop || pending.load() > 0; });
+            if (stop && pending.load() == 0)
+                return;
+        }
+    }
+};
+
+/*
+ 一组fork-join任务：run()把子任务交给线程池，wait()等待这一组任务全部完成。
+ 子任务里可以继续往同一个组里run()，wait()期间当前线程也会帮忙执行任务。
+ 子任务抛出的异常在任务里捕获(不会跑到工作线程里让程序terminate)，计数照样减一，
+ wait()等所有任务结束后重新抛出第一个异常；析构函数只等待，不抛异常。
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool &pool = WorkStealingPool::instance()) : pool(pool), unfinished(0) {}
+
+    ~TaskGroup() { join(); }
+
+    TaskGroup(const TaskGroup &) = delete;
+
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    void run(const WorkStealingPool::Task &task) {
+        unfinished++;
+        pool.submit([this, task]() {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+            unfinished--;
+        });
+    }
+
+    void wait() {
+        join();
+        std::exception_ptr e;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            std::swap(e, error);
+        }
+        if (e)
+            std::rethrow_exception(e);
+    }
+
+    WorkStealingPool &threadPool() { return pool; }
+
+private:
+    WorkStealingPool &pool;
+    std::atomic<int> unfinished;
+    std::mutex errorMutex;
+    std::exception_ptr error;   //第一个抛出的异常
+
+    void join() {
+        while (unfinished.load() > 0) {
+            if (!pool.runPendingTask())
+                std::this_thread::yield();
+        }
+    }
+};
+
+#endif //WORKSTEALINGPOOL_HPP
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+#include "ExternSort.hpp"
+#include "SortUtil.hpp"
+
+using namespace std;
+
+//带负载的定长记录，按key排序
+struct Record {
+    long long key;
+    char payload[56];
+};
+
+struct RecordLess {
+    bool operator()(const Record &a, const Record &b) const {
+        return a.key < b.key;
+    }
+};
+
+//输出文件有序，并且记录数和校验和都和输入一致
+template<typename T, typename Compare>
+bool isSortedFile(const string &fileName, size_t expect, uint64_t expectChecksum, Compare comp) {
+    BlockReader<T> in(fileName.c_str());
+    T prev = T(), cur;
+    size_t n = 0;
+    uint64_t checksum = 0;
+    bool sorted = true;
+    while (in.next(cur)) {
+        if (n > 0 && comp(cur, prev))
+            sorted = false;
+        checksum += SortUtil<T>::checksumOf(cur);
+        prev = cur;
+        n++;
+    }
+    return sorted && n == expect && checksum == expectChecksum;
+}
+
+template<typename T, typename Compare, typename Generator>
+void testExternSort(const string &name, size_t num, size_t memoryBytes, int maxFanIn, bool replacement,
+                    Generator gen) {
+    string input = "extern-sort-input.bin";
+    string output = "extern-sort-output.bin";
+    uint64_t checksum = 0;
+    {
+        BlockWriter<T> in(input.c_str());
+        for (size_t i = 0; i < num; i++) {
+            T x = gen(i);
+            checksum += SortUtil<T>::checksumOf(x);
+            in.write(x);
+        }
+    }
+
+    ExternSort<T, Compare> sorter(memoryBytes);
+    sorter.blockBytes = 256 << 10;
+    sorter.maxFanIn = maxFanIn;
+    sorter.replacementSelection = replacement;
+
+    auto start = chrono::steady_clock::now();
+    sorter.sort(input, output);
+    auto end = chrono::steady_clock::now();
+    double duration = chrono::duration<double>(end - start).count();
+
+    bool res = isSortedFile<T>(output, num, checksum, Compare());
+    cout << name << (replacement ? " (replacement selection)" : "") << ": " << num << " records, " << sorter.runCount() << " runs, fan-in " << sorter.fanIn()
+         << ", " << sorter.mergePasses() << " merge passes, " << duration << " s"
+         << ", result = " << (res ? "true" : "false") << endl;
+
+    unlink(input.c_str());
+    unlink(output.c_str());
+}
+
+int main(int argc, char *argv[]) {
+    size_t num = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    size_t memoryBytes = (argc > 2 ? strtoull(argv[2], nullptr, 10) : 16) << 20;
+    int maxFanIn = argc > 3 ? atoi(argv[3]) : 0;
+
+    srand(time(NULL));
+    for (int replacement = 0; replacement < 2; replacement++) {
+        testExternSort<int, less<int> >("int", num, memoryBytes, maxFanIn, replacement,
+                                        [](size_t) { return rand(); });
+        //基本有序：每个元素在有序位置附近随机偏移
+        testExternSort<int, less<int> >("nearly sorted int", num, memoryBytes, maxFanIn, replacement,
+                                        [](size_t i) { return (int) i + rand() % 1000; });
+        testExternSort<Record, RecordLess>("record", num / 16, memoryBytes, maxFanIn, replacement, [](size_t) {
+            Record r;
+            r.key = ((long long) rand() << 31) | rand();
+            memset(r.payload, 0, sizeof(r.payload));
+            return r;
+        });
+    }
+    return 0;
+}
@@ -1,230 +1,353 @@
 #include <iostream>
-#include <sys/time.h>
-#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <cstring>
 #include <algorithm>
-#include <thread>
+#include <chrono>
 #include <functional>
-#include<future>      //std::future std::promise
-#include<utility>     //std::ref
-#include<chrono>      //std::chrono::seconds
+#include <sstream>
+#include <string>
+#include <vector>
 
+#include "BubbleSort.hpp"
+#include "SelectSort.hpp"
+#include "InsertSort.hpp"
+#include "ShellSort.hpp"
 #include "QuickSort.hpp"
 #include "HeapSort.hpp"
 #include "MergeSort.hpp"
+#include "MergeSortMuiltThread.hpp"
 #include "QuickSortMuiltThread.hpp"
-#include "InsertSort.hpp"
+#include "RadixSort.hpp"
+#include "SampleSort.hpp"
+#include "IndexSort.hpp"
+#include "Select.hpp"
+#include "SortBenchmark.hpp"
+#include "PerfCounters.hpp"
 
 using namespace std;
 
+//200字节的记录，只按开头8字节的key排序
+struct Record {
+    long long key;
+    char payload[192];
 
-template<typename T>
-bool isSorted(T *arr, const int lo, const int hi) {
-    for (int i = lo; i < hi; i++)
-        if (arr[i] > arr[i + 1])
-            return false;
-    return true;
-}
+    bool operator<(const Record &that) const { return key < that.key; }
 
-template<typename T>
-bool isSorted(T *arr, const int len) {
-    return isSorted(arr, 0, len - 1);
-}
-
-
-template<typename T>
-T *cloneArray(T *arr, const int len) {
-    T *dst = new T[len];
-    for (int i = 0; i < len; i++)
-        dst[i] = arr[i];
-    return dst;
-}
+    bool operator>(const Record &that) const { return key > that.key; }
+};
 
-template<typename T>
-T *generateRandomArray(int num, int lo, int hi) {
-    T *arr = new T[num];
-    for (int i = 0; i < num; i++)
-        arr[i] = rand() % (hi - lo + 1) + lo;
-    return arr;
-}
+struct RecordKey {
+    long long operator()(const Record &r) const { return r.key; }
+};
 
-template<typename T>
-T *generateSortedArray(int num, bool reverse) {
-    T *arr = new T[num];
-    if (reverse) {
-        for (int i = 0; i < num; i++)
-            arr[i] = i;
-    } else {
-        for (int i = 0; i < num; i++)
-            arr[i] = num - i - 1;
+template<>
+struct BenchmarkValue<Record> {
+    static Record from(const long long key) {
+        Record r;
+        r.key = key;
+        memset(r.payload, (int) (key & 0xff), sizeof(r.payload));
+        return r;
     }
-
-    return arr;
+};
+
+//O(n^2)的排序只跑小规模
+static const int QUADRATIC_MAX_SIZE = 1 << 14;
+//记录200字节，一百万条就是200MB
+static const int RECORD_MAX_SIZE = 1 << 20;
+
+//指定叉数的d叉堆排序，和默认(按缓存行选叉数)的HeapSort::sortAdvanced对比
+template<int ARITY>
+static void addHeapSortArity(SortBenchmark<int> &bench) {
+    bench.add("HeapSort<" + to_string(ARITY) + ">::sortAdvanced",
+              [](int *arr, int len) { HeapSort<int, ARITY>().sortAdvanced(arr, len); },
+              [](Counted<int> *arr, int len) { HeapSort<Counted<int>, ARITY>().sortAdvanced(arr, len); });
 }
 
+/*
+ ±0.0混着几个小整数的浮点数组，各种长度都试一遍：向量化的排序(排序网络、QuickSort/MergeSort::sortAdvanced)
+ 结果要有序，而且是输入的一个排列(校验和按字节算，-0.0和+0.0不一样)；
+ MergeSort是稳定的，结果还要和std::stable_sort逐字节一样(-0.0和+0.0保持原来的顺序)。失败的次数输出到标准错误
+ */
 template<typename T>
-T *generateNearlyRandomArray(int num, int swapNum) {
-    T *arr = new T[num];
-    for (int i = 0; i < num; i++)
-        arr[i] = i;
-    for (int i = 0; i < swapNum; i++) {
-        int a = rand() % num;
-        int b = rand() % num;
-        swap(arr[a], arr[b]);
+static bool checkSignedZeros(const char *type) {
+    mt19937 rng(20210223);
+    int failures[3] = {0, 0, 0};
+    for (int t = 0; t < 2000; t++) {
+        const int n = 1 + (int) (rng() % 300);
+        vector<T> input(n);
+        for (T &x : input) {
+            unsigned r = rng() % 4;
+            x = r == 0 ? T(-0.0) : r == 1 ? T(0.0) : T((int) (rng() % 7) - 3);
+        }
+        const uint64_t checksum = SortUtil<T>::checksum(input.data(), n);
+        vector<T> stable = input;
+        std::stable_sort(stable.begin(), stable.end());
+        for (int k = 0; k < 3; k++) {
+            vector<T> arr = input;
+            if (k == 0 && !SortingNetwork<T>::sort(arr.data(), n))
+                std::sort(arr.begin(), arr.end());
+            else if (k == 1)
+                QuickSort<T>().sortAdvanced(arr.data(), n);
+            else if (k == 2)
+                MergeSort<T>().sortAdvanced(arr.data(), n);
+            if (!SortUtil<T>::isSorted(arr.data(), n) || SortUtil<T>::checksum(arr.data(), n) != checksum
+                || (k == 2 && memcmp(arr.data(), stable.data(), n * sizeof(T)) != 0))
+                failures[k]++;
+        }
     }
-    return arr;
-}
-
-template<typename T>
-double test_sort_function(const string& sortName, T* arr, const int len, const function<void(decltype(arr), decltype(len))>&sort_function) {
-    struct timeval start, end;
-    double duration = 0;
-    gettimeofday(&start, NULL);
-
-    sort_function(arr, len);
-
-    gettimeofday(&end, NULL);
-
-    duration = ((end.tv_sec - start.tv_sec) * pow(10, 6) + (end.tv_usec - start.tv_usec)) / pow(10, 6);
-
-    bool res = isSorted(arr, len);
-    cout << sortName << (duration < 1 ? duration * 1000 : duration) << ((duration < 1) ? "ms" : " s")
-         << ", result = " << (res == true ? ("true") : ("false")) << endl;
-    return duration;
+    const char *names[3] = {"SortingNetwork::sort", "QuickSort::sortAdvanced", "MergeSort::sortAdvanced"};
+    bool ok = true;
+    for (int k = 0; k < 3; k++) {
+        if (failures[k] > 0) {
+            cerr << type << " " << names[k] << ": " << failures[k] << "/2000个带±0.0的数组排错了" << endl;
+            ok = false;
+        }
+    }
+    return ok;
 }
 
-template<typename sort_alg, typename T>
-void test_sort(const string& sortName, sort_alg&& sort, T* arr, const int len) {
-
-    auto sort_functions = {
-        bind(&sort_alg::sortIterative, sort, std::placeholders::_1, std::placeholders::_2),
-        bind(&sort_alg::sortRecursive, sort, std::placeholders::_1, std::placeholders::_2),
-        bind(&sort_alg::sortAdvanced, sort, std::placeholders::_1, std::placeholders::_2),
+//选择算法：nth为true时求第k小(只检查arr[k])，否则求最小的k个并排好序(检查arr[0, k))
+struct SelectAlgorithm {
+    string name;
+    function<void(int *, int, int)> select;
+    bool nth;
+};
+
+static vector<SelectAlgorithm> selectAlgorithms() {
+    return {
+            {"std::nth_element", [](int *arr, int len, int k) { std::nth_element(arr, arr + k, arr + len); }, true},
+            {"Select::nthElement", [](int *arr, int len, int k) { Select<int>().nthElement(arr, len, k); }, true},
+            {"std::partial_sort", [](int *arr, int len, int k) { std::partial_sort(arr, arr + k, arr + len); }, false},
+            {"Select::topKHeap", [](int *arr, int len, int k) { Select<int>().topKHeap(arr, len, k); }, false},
+            {"Select::topKPartition", [](int *arr, int len, int k) { Select<int>().topKPartition(arr, len, k); }, false},
+            {"Select::partialSort", [](int *arr, int len, int k) { Select<int>().partialSort(arr, len, k); }, false},
+            {"Select::parallelTopK", [](int *arr, int len, int k) { Select<int>().parallelTopK(arr, len, k); }, false}
     };
-
-    for(const auto& fun : sort_functions) {
-        T * backArr = cloneArray(arr, len);
-        test_sort_function(sortName + " 迭代: ", backArr, len, fun);
-        delete[] backArr;
-    }
 }
 
+//结果和标准库一样，并且是输入的一个排列；nth时还要arr[0, k) <= arr[k] <= arr(k, len)
+static bool checkSelected(const SelectAlgorithm &algorithm, const int *arr, const int len, const int k,
+                          const vector<int> &expected, const uint64_t checksum) {
+    if (SortUtil<int>::checksum(arr, len) != checksum)
+        return false;
+    if (!algorithm.nth)
+        return equal(arr, arr + k, expected.begin());
+    if (arr[k] != expected[k])
+        return false;
+    for (int i = 0; i < len; i++)
+        if (i < k ? arr[k] < arr[i] : arr[i] < arr[k])
+            return false;
+    return true;
+}
 
+//expected[0, k)是最小的k个并且有序，expected[k]是第k小(k < len时)
+static vector<int> expectedSelection(const vector<int> &input, const int k) {
+    vector<int> expected = input;
+    std::partial_sort(expected.begin(), expected.begin() + min(k + 1, (int) expected.size()), expected.end());
+    return expected;
+}
 
-namespace test_thread_quick_sort {
-
-    template<typename T>
-    int partitionAdvance(T *arr, int lo, int hi) {
-        int randIndex = rand() % (hi - lo + 1) + lo;
-        swap(arr[lo], arr[randIndex]);
-
-        T pivot = arr[lo];
-        int i = lo + 1, j = hi;
-        while (true) {
-            while (i <= hi && arr[i] <= pivot) i++;
-            while (j >= lo + 1 && arr[j] >= pivot) j--;
-            if (i >= j)
-                break;
-            //swap(arr, i, j);
-            swap(arr[i], arr[j]);
+//各种长度、分布和k，和std::nth_element、std::partial_sort的结果对比，出错的输出到标准错误
+static bool checkSelect() {
+    mt19937 rng(20210223);
+    bool ok = true;
+    const InputDistribution dists[] = {RANDOM_INPUT, SORTED_INPUT, REVERSED_INPUT, FEW_UNIQUE_INPUT, ZIPF_INPUT};
+    for (const SelectAlgorithm &algorithm : selectAlgorithms()) {
+        int failures = 0;
+        for (int t = 0; t < 300; t++) {
+            const int len = t % 3 == 0 ? 1 + (int) (rng() % 100000) : 1 + (int) (rng() % 2000);
+            const int k = algorithm.nth ? (int) (rng() % len) : 1 + (int) (rng() % (t % 2 ? len : min(len, 64)));
+            vector<long long> keys = generateKeys(dists[t % 5], len, rng());
+            vector<int> input(keys.begin(), keys.end());
+            vector<int> expected = expectedSelection(input, k);
+            vector<int> arr = input;
+            algorithm.select(arr.data(), len, k);
+            if (!checkSelected(algorithm, arr.data(), len, k, expected, SortUtil<int>::checksum(input.data(), len)))
+                failures++;
+        }
+        if (failures > 0) {
+            cerr << algorithm.name << ": " << failures << "/300次选择的结果和标准库不一样" << endl;
+            ok = false;
         }
-        /* 最后退出时arr[i] >= pivot，arr[j] =< pivot，
-        我们应该将小于pivot的数交换到第一个元素的位置，也就是
-        交换arr[j]和arr[lo]
-        */
-        //swap(arr, lo, j);
-        swap(arr[lo], arr[j]);
-        return j;
     }
+    return ok;
+}
 
-    template<typename T>
-    void sortSingeleThread(T* arr, const int lo, const int hi) {
-        cout << "thread ID " << std::this_thread::get_id() << endl;
-        std::sort(arr+lo, arr+hi+1);
+/*
+ 选择算法的计时，和SortBenchmark一样每次从输入的拷贝开始，报告中位数、p95和最小值；
+ nth取中位数(k = len/2)，前k个取k = 100和k = len/100。sorted一列表示结果和标准库一致
+ */
+static vector<BenchmarkResult> benchmarkSelect(const BenchmarkConfig &config) {
+    vector<BenchmarkResult> results;
+    for (int size : config.sizes) {
+        for (InputDistribution dist : config.distributions) {
+            vector<long long> keys = generateKeys(dist, size, config.seed);
+            const vector<int> input(keys.begin(), keys.end());
+            const uint64_t checksum = SortUtil<int>::checksum(input.data(), size);
+            vector<int> topKs = {min(size, 100)};
+            if (size / 100 > 100)
+                topKs.push_back(size / 100);
+            for (const SelectAlgorithm &algorithm : selectAlgorithms()) {
+                vector<int> ks = algorithm.nth ? vector<int>{size / 2} : topKs;
+                for (int k : ks) {
+                    if (k <= 0 || k >= size + (algorithm.nth ? 0 : 1))
+                        continue;
+                    vector<int> expected = expectedSelection(input, k);
+                    BenchmarkResult result;
+                    result.algorithm = "select/" + algorithm.name + " k=" + to_string(k);
+                    result.distribution = distributionName(dist);
+                    result.size = size;
+                    result.repetitions = config.repetitions;
+                    result.comparisons = -1;
+                    result.moves = -1;
+                    result.sorted = true;
+                    result.permutation = true;
+                    vector<int> arr;
+                    vector<double> times;
+                    for (int r = 0; r < config.warmup + config.repetitions; r++) {
+                        arr = input;
+                        auto start = chrono::steady_clock::now();
+                        algorithm.select(arr.data(), size, k);
+                        auto end = chrono::steady_clock::now();
+                        if (r >= config.warmup)
+                            times.push_back(chrono::duration<double, milli>(end - start).count());
+                        if (!checkSelected(algorithm, arr.data(), size, k, expected, checksum))
+                            result.sorted = false;
+                        if (SortUtil<int>::checksum(arr.data(), size) != checksum)
+                            result.permutation = false;
+                    }
+                    sort(times.begin(), times.end());
+                    result.medianMs = times[(times.size() - 1) / 2];
+                    result.p95Ms = times[max(0, (int) ceil(times.size() * 0.95) - 1)];
+                    result.minMs = times[0];
+                    result.elementsPerSec = result.medianMs > 0 ? size / (result.medianMs / 1000) : 0;
+                    cerr << result.algorithm << " " << result.distribution << " n=" << size
+                         << " median=" << result.medianMs << "ms" << (result.sorted ? "" : " WRONG") << endl;
+                    results.push_back(result);
+                }
+            }
+        }
     }
+    return results;
+}
 
-    template<typename T>
-    void twoThreadQuickSort(T* arr, const int lo, const int hi){
-        int p = partitionAdvance(arr, lo, hi);
-        //cout << (hi+lo) << " <<>> " << p << endl;
-        thread t1 = thread(sortSingeleThread<T>, arr, lo, p-1);
-        thread t2 = thread(sortSingeleThread<T>, arr, p+1, hi);
-        cout << "1111111111" << endl;
-        t1.join();
-        cout << "2222222222" << endl;
-        t2.join();
-        cout << "3333333333" << endl;
-    }
+static void usage(const char *name) {
+    cerr << "用法: " << name << " [--sizes=10000,1000000] [--distributions=random,sorted,...]\n"
+         << "       [--repetitions=5] [--warmup=1] [--format=csv|json] [--no-count] [--seed=N] [--perf]\n"
+         << "分布: random sorted reversed nearly_sorted few_unique zipf\n"
+         << "--perf: 用perf_event_open统计cycles、instructions、branch-misses、L1/LLC缺失\n"
+         << "结果输出到标准输出，进度输出到标准错误" << endl;
+}
 
-    template<typename T>
-    void twoThreadQuickSort(T* arr, const int len){
-        twoThreadQuickSort(arr, 0, len - 1);
-    }
+static vector<string> split(const string &s) {
+    vector<string> items;
+    stringstream in(s);
+    string item;
+    while (getline(in, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
 
-    template<typename T>
-    void stdSortVSMuiltThreadSort(T* arr, const int len) {
-      
-        T* copy;
-
-        copy = cloneArray(arr, len);
-        
-        struct timeval start, end;
-        double duration = 0;
-        bool res;
-        gettimeofday(&start, NULL);
-        test_thread_quick_sort::twoThreadQuickSort(copy, len);
-        gettimeofday(&end, NULL);
-
-        duration = ((end.tv_sec - start.tv_sec) * pow(10, 6) + (end.tv_usec - start.tv_usec)) / pow(10, 6);
-        res = isSorted(copy, len);
-        cout << "多线程快速排序" << (duration < 1 ? duration * 1000 : duration) << ((duration < 1) ? "ms" : " s")
-        << ", result = " << (res == true ? ("true") : ("false")) << endl;
-        delete[] copy;
-
-
-        copy = cloneArray(arr, len);
-        gettimeofday(&start, NULL);
-        sort(arr, arr+len/2);
-        gettimeofday(&end, NULL);
-
-        duration = ((end.tv_sec - start.tv_sec) * pow(10, 6) + (end.tv_usec - start.tv_usec)) / pow(10, 6);
-        res = isSorted(arr, len);
-        cout << "std::sort" << (duration < 1 ? duration * 1000 : duration) << ((duration < 1) ? "ms" : " s")
-        << ", result = " << (res == true ? ("true") : ("false")) << endl;
-
-        delete[] copy;
+//解析命令行，出错时打印用法并退出
+static void parseArgs(int argc, char *argv[], BenchmarkConfig &config, string &format) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value = arg.find('=') == string::npos ? "" : arg.substr(arg.find('=') + 1);
+        if (arg.compare(0, 8, "--sizes=") == 0) {
+            config.sizes.clear();
+            for (const string &s : split(value))
+                config.sizes.push_back(atoi(s.c_str()));
+        } else if (arg.compare(0, 16, "--distributions=") == 0) {
+            config.distributions.clear();
+            for (const string &s : split(value)) {
+                InputDistribution dist;
+                if (!parseDistribution(s, dist)) {
+                    cerr << "未知的分布: " << s << endl;
+                    usage(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                config.distributions.push_back(dist);
+            }
+        } else if (arg.compare(0, 14, "--repetitions=") == 0) {
+            config.repetitions = max(1, atoi(value.c_str()));
+        } else if (arg.compare(0, 9, "--warmup=") == 0) {
+            config.warmup = max(0, atoi(value.c_str()));
+        } else if (arg.compare(0, 9, "--format=") == 0 && (value == "csv" || value == "json")) {
+            format = value;
+        } else if (arg == "--no-count") {
+            config.countOperations = false;
+        } else if (arg == "--perf") {
+            config.perfCounters = true;
+        } else if (arg.compare(0, 7, "--seed=") == 0) {
+            config.seed = (unsigned) strtoul(value.c_str(), nullptr, 10);
+        } else {
+            usage(argv[0]);
+            exit(arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
     }
+}
 
-
-
-} // test_thread_quick_sort
-
-int main(void) {
-    const int num = 1000;
-    const int len = 10000 * num;
-    int *arr;
-    //arr = generateRandomArray<int>(len, 0, len);
-    int* copy;
-    while(1){
-        // arr = generateSortedArray<int>(len, false);
-        arr = generateRandomArray<int>(len, 0, len);
-        //test_sort("快速排序", QuickSort<int>(), arr, len);
-        //test_sort("堆排序", HeapSort<int>(), arr, len);
-        //test_sort("归并排序", MergeSort<int>(), arr, len);
-        //test_sort("多线程快速排序", QuickSortMuiltThread<int>(), arr, len);
-        
-        // auto t = test_sort_function("插入排序 改进: ", arr, len, bind(&InsertSort<int>::sortAdvanced, InsertSort<int>(), std::placeholders::_1, std::placeholders::_2));
-
-        std::thread qt([=](){test_sort("快速排序", QuickSort<int>(), arr, len);});
-        std::thread ht([=](){test_sort("堆排序", HeapSort<int>(), arr, len);});
-        std::thread mt([=](){test_sort("归并排序", MergeSort<int>(), arr, len);});
-        std::thread mqt([=](){test_sort("多线程快速排序", QuickSortMuiltThread<int>(), arr, len);});
-
-        qt.join();
-        ht.join();
-        mt.join();
-        mqt.join();
-        delete[] arr;
-    }
+int main(int argc, char *argv[]) {
+    BenchmarkConfig config;
+    config.sizes = {10000, 1000000};
+    config.distributions = {RANDOM_INPUT, SORTED_INPUT, REVERSED_INPUT,
+                            NEARLY_SORTED_INPUT, FEW_UNIQUE_INPUT, ZIPF_INPUT};
+    string format = "csv";
+    parseArgs(argc, argv, config, format);
+    if (config.perfCounters && !PerfCounters::supported())
+        cerr << "无法打开硬件性能计数器(没有权限或者内核不支持)，计数器各项输出-1" << endl;
+
+    if (!checkSignedZeros<float>("float") || !checkSignedZeros<double>("double") || !checkSelect())
+        return EXIT_FAILURE;
+
+    SortBenchmark<int> bench;
+    bench.add("std::sort",
+              [](int *arr, int len) { std::sort(arr, arr + len); },
+              [](Counted<int> *arr, int len) { std::sort(arr, arr + len); });
+    bench.add("std::stable_sort",
+              [](int *arr, int len) { std::stable_sort(arr, arr + len); },
+              [](Counted<int> *arr, int len) { std::stable_sort(arr, arr + len); });
+    bench.addSortClass<BubbleSort<int>, BubbleSort<Counted<int> > >("BubbleSort", QUADRATIC_MAX_SIZE);
+    bench.addSortClass<SelectSort<int>, SelectSort<Counted<int> > >("SelectSort", QUADRATIC_MAX_SIZE);
+    bench.addSortClass<InsertSort<int>, InsertSort<Counted<int> > >("InsertSort", QUADRATIC_MAX_SIZE);
+    bench.addSortClass<ShellSort<int>, ShellSort<Counted<int> > >("ShellSort");
+    bench.addSortClass<QuickSort<int>, QuickSort<Counted<int> > >("QuickSort");
+    bench.addSortClass<HeapSort<int>, HeapSort<Counted<int> > >("HeapSort");
+    addHeapSortArity<2>(bench);
+    addHeapSortArity<4>(bench);
+    bench.addSortClass<MergeSort<int>, MergeSort<Counted<int> > >("MergeSort");
+    bench.addSortClass<MergeSortMuiltThread<int>, MergeSortMuiltThread<Counted<int> > >("MergeSortMuiltThread");
+    bench.addSortClass<QuickSortMuiltThread<int>, QuickSortMuiltThread<Counted<int> > >("QuickSortMuiltThread");
+    bench.addSortClass<SampleSort<int>, SampleSort<Counted<int> > >("SampleSort");
+    bench.addSortClass<RadixSort<int> >("RadixSort");
+    vector<BenchmarkResult> results = bench.run(config, &cerr);
+
+    //字符串键(定长补零的数字串)：MSD基数排序和比较排序的对比
+    SortBenchmark<string> stringBench;
+    stringBench.add("string/std::sort",
+                    [](string *arr, int len) { std::sort(arr, arr + len); },
+                    [](Counted<string> *arr, int len) { std::sort(arr, arr + len); });
+    stringBench.addSortClass<RadixSort<string> >("string/RadixSort");
+    vector<BenchmarkResult> stringResults = stringBench.run(config, &cerr);
+    results.insert(results.end(), stringResults.begin(), stringResults.end());
+
+    vector<BenchmarkResult> selectResults = benchmarkSelect(config);
+    results.insert(results.end(), selectResults.begin(), selectResults.end());
+
+    //大记录按小键排序：直接搬记录和只搬(键, 下标)对的对比
+    SortBenchmark<Record> recordBench;
+    recordBench.add("Record/QuickSort::sortAdvanced",
+                    [](Record *arr, int len) { QuickSort<Record>().sortAdvanced(arr, len); },
+                    SortBenchmark<Record>::CountedSortFunction(), RECORD_MAX_SIZE);
+    recordBench.addSortClass<IndexSort<Record, RecordKey> >("Record/IndexSort", RECORD_MAX_SIZE);
+    vector<BenchmarkResult> recordResults = recordBench.run(config, &cerr);
+    results.insert(results.end(), recordResults.begin(), recordResults.end());
+
+    if (format == "json")
+        SortBenchmark<int>::writeJson(cout, results);
+    else
+        SortBenchmark<int>::writeCsv(cout, results);
     return 0;
 }
-